@@ -119,6 +119,8 @@ inline std::unique_ptr<Protocol> ParseProtocol(const char* arg, Workload& worklo
     OPT(SparklePartial,     INT, INT, EVMTYPE)
     OPT(SparklePreSched,    INT, INT, EVMTYPE)
     OPT(Spectrum,           INT, INT, EVMTYPE)
+    OPT(SpectrumHint,       INT, INT, EVMTYPE)
+    OPT(SpectrumEpoch,      INT, INT, EVMTYPE, INT)
     OPT(SpectrumSched,      INT, INT, EVMTYPE)
     OPT(SpectrumCache,      INT, INT, EVMTYPE)
     OPT(SpectrumPreSched,   INT, INT, EVMTYPE)
@@ -9,6 +9,7 @@
 #include <glog/logging.h>
 #include <string.h>
 #include "argparse.hpp"
+#include <spectrum/workload/pipeline.hpp>
 #include <spectrum/common/glog-prefix.hpp>
 
 int main(int argc, char* argv[]) {
@@ -23,13 +24,23 @@ int main(int argc, char* argv[]) {
     // parse args and allocate resources
     auto statistics = std::make_unique<Statistics>();
     auto workload = ParseWorkload(argv[2]);
-    auto protocol = ParseProtocol(argv[1], *workload, *statistics);
+    auto pipeline = FLAGS_generators == 0 ? nullptr : std::make_unique<Pipeline>(
+        *workload, FLAGS_generators, std::thread::hardware_concurrency(), 64
+    );
+    auto protocol = ParseProtocol(argv[1], pipeline ? *pipeline : *workload, *statistics);
     auto duration = to<milliseconds>(argv[3]);
-    // start running
+    // start running, generators start after the protocol has set the evm type
+    if (pipeline) { pipeline->Start(); }
     auto start_time = steady_clock::now();
+    auto allocations = CountAllocations();
+    auto analysis    = CountAnalysisTime();
     protocol->Start();
     std::this_thread::sleep_for(duration);
     protocol->Stop();
+    // generators keep refilling rings until stopped, keep their allocations out of the sample
+    if (pipeline) { pipeline->Stop(); }
+    statistics->JournalAllocations(CountAllocations() - allocations);
+    statistics->JournalAnalysis(CountAnalysisTime() - analysis);
     // stop running and print statistics
     DLOG(WARNING) << "Debug Mode: don't expect good performance. " << std::endl;
     std::cerr << statistics->PrintWithDuration(duration_cast<milliseconds>(steady_clock::now() - start_time));
@@ -13,7 +13,7 @@
 #include "argparse.hpp"
 #include <spectrum/common/glog-prefix.hpp>
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 
 /// @brief mock table for collecting workload characteristics
 class MockTable {
@@ -28,14 +28,14 @@ class MockTable {
         const evmc::address& addr, 
         const evmc::bytes32& key
     ) {
-        auto& entry = histogram[std::make_tuple(addr, key)];
+        auto& entry = histogram[K(addr, key)];
         if (!entry.size() || std::get<0>(entry[entry.size() - 1]) != id) {
             entry.push_back({id, 'g'});
         }
         else if (std::get<1>(entry[entry.size() - 1]) != 'd') {
             std::get<1>(entry[entry.size() - 1]) = 'd';
         }
-        return inner[std::make_tuple(addr, key)];
+        return inner[K(addr, key)];
     }
 
     void SetStorage(
@@ -44,14 +44,14 @@ class MockTable {
         const evmc::bytes32& key, 
         const evmc::bytes32& value
     ) {
-        auto& entry = histogram[std::make_tuple(addr, key)];
+        auto& entry = histogram[K(addr, key)];
         if (!entry.size() || std::get<0>(entry[entry.size() - 1]) != id) {
             entry.push_back({id, 'p'});
         }
         else if (std::get<1>(entry[entry.size() - 1]) != 'p') {
             std::get<1>(entry[entry.size() - 1]) = 'd';
         }
-        inner[std::make_tuple(addr, key)] = value;
+        inner[K(addr, key)] = value;
     }
 
     std::unordered_map<K, std::string, spectrum::KeyHasher> Report(size_t counter) {
@@ -116,8 +116,8 @@ int main(int argc, char* argv[]) {
     std::cerr << "'?' represents get, '!' represents put, 'x' represents both, '-' represents no-operation" << std::endl;
     std::cerr << statistics->PrintWithDuration(duration_cast<milliseconds>(steady_clock::now() - start_time));
     for (auto& entry: mock_table.Report(counter)) {
-        auto& addr  = std::get<0>(std::get<0>(entry));
-        auto& key   = std::get<1>(std::get<0>(entry));
+        auto addr   = std::get<0>(entry).Address();
+        auto key    = std::get<0>(entry).Key();
         auto& hist  = std::get<1>(entry);
         std::cerr << to_hex(std::span{(uint8_t*)&addr, 20}) << ":" << to_hex(std::span{(uint8_t*)&key, 32}) << std::endl;
         std::cerr << hist << std::endl;
@@ -0,0 +1,62 @@
+#include <spectrum/common/lock-util.hpp>
+#include <fmt/core.h>
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+
+using namespace std::chrono;
+using namespace spectrum;
+
+struct QueueTx { size_t id; };
+
+/// @brief pop and push back transactions from many threads, as the scheduled executors do
+/// @param num_threads the number of threads sharing the queue
+/// @param duration how long the threads keep running
+/// @return operations per second
+template<typename Queue>
+size_t BenchQueue(size_t num_threads, milliseconds duration) {
+    auto queue = Queue();
+    for (size_t i = 1; i <= num_threads * 4; ++i) { queue.Push(std::make_unique<QueueTx>(QueueTx{i})); }
+    auto stop_flag  = std::atomic<bool>{false};
+    auto count      = std::atomic<size_t>{0};
+    auto next_id    = std::atomic<size_t>{num_threads * 4 + 1};
+    auto threads    = std::vector<std::thread>();
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]{
+            auto i = size_t{0};
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                auto tx = queue.Pop();
+                // finalize some transactions, and put the others back
+                if (tx == nullptr || i % 4 == 0) { tx = std::make_unique<QueueTx>(QueueTx{next_id.fetch_add(1)}); }
+                queue.Push(std::move(tx));
+                ++i;
+            }
+            count.fetch_add(i);
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    stop_flag.store(true);
+    for (auto& t: threads) { t.join(); }
+    return count.load() * 1000 / duration.count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [duration_ms]\n";
+        return 1;
+    }
+    auto duration = milliseconds(argc > 1 ? std::stoul(argv[1]) : 100);
+    std::cout << fmt::format("duration={}ms", duration.count()) << std::endl;
+    for (auto num_threads: {1, 4, 16, 64}) {
+        std::cout << fmt::format(
+            "threads={:<2} lock-priority-queue={:>10} op/s ring-priority-queue={:>10} op/s",
+            num_threads,
+            BenchQueue<LockPriorityQueue<QueueTx>>(num_threads, duration),
+            BenchQueue<RingPriorityQueue<QueueTx>>(num_threads, duration)
+        ) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <spectrum/evmone/execution_state.hpp>
+#include <spectrum/evmone/instructions.hpp>
+#include <spectrum/evmcow/execution_state.hpp>
+#include <fmt/core.h>
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <string>
+
+using namespace std::chrono;
+
+// items kept under the working top, like the locals of a contract function
+constexpr size_t depth = 16;
+
+/// @brief keep the compiler from folding the stack operations of a round into the next one
+inline void Clobber() {
+    asm volatile("" ::: "memory");
+}
+
+/// @brief push, swap and pop on evmone's flat stack
+/// @param rounds the number of push-push-swap-pop-pop rounds
+/// @return a checksum of the popped items
+uint64_t FlatStack(size_t rounds) {
+    auto space = std::make_unique<evmone::StackSpace>();
+    auto stack = evmone::StackTop(space->bottom());
+    auto checksum = uint64_t{0};
+    for (size_t i = 0; i < depth; ++i) { stack.push(i); }
+    for (size_t i = 0; i < rounds; ++i) {
+        stack.push(i);
+        stack.push(~i);
+        std::swap(stack[0], stack[1]);
+        checksum += stack.pop()[0];
+        checksum ^= stack.pop()[0];
+        Clobber();
+    }
+    return checksum;
+}
+
+/// @brief push, swap and pop on the copy-on-write stack, taking a checkpoint every few rounds
+/// @tparam S the number of items in a slice
+/// @param rounds the number of push-push-swap-pop-pop rounds
+/// @param interval the number of rounds between two checkpoints, 0 means never
+/// @return a checksum of the popped items
+template<size_t S>
+uint64_t CopyOnWriteStack(size_t rounds, size_t interval) {
+    using Stack = evmcow::BasicStackTop<S>;
+    auto space = std::make_unique<evmcow::StackSpace>();
+    auto begin = &space->m_stack_space[0];
+    auto end   = &space->m_stack_space[0] + space->limit;
+    auto stack = Stack(begin, end);
+    auto checkpoint = Stack();
+    auto checksum = uint64_t{0};
+    for (size_t i = 0; i < depth; ++i) { stack.push(i); }
+    for (size_t i = 0; i < rounds; ++i) {
+        if (interval != 0 && i % interval == 0) {
+            // start over before checkpoints use up the stack space
+            if (stack.base + 4 * S > end) {
+                stack = Stack(begin, end);
+                for (size_t j = 0; j < depth; ++j) { stack.push(j); }
+            }
+            checkpoint = stack;
+            stack.share();
+        }
+        stack.push(i);
+        stack.push(~i);
+        std::swap(stack.get_mut(0), stack.get_mut(1));
+        checksum += stack.pop()[0];
+        checksum ^= stack.pop()[0];
+        Clobber();
+    }
+    return checksum + checkpoint.height;
+}
+
+/// @brief time a stack and print its throughput
+/// @param name the name of the stack
+/// @param rounds the number of rounds the stack runs
+/// @param run the function running the stack
+template<typename F>
+void Measure(const std::string& name, size_t rounds, F&& run) {
+    auto start_time = steady_clock::now();
+    auto checksum = run();
+    auto duration = duration_cast<nanoseconds>(steady_clock::now() - start_time).count();
+    // each round has two pushes, one swap and two pops
+    std::cout << fmt::format(
+        "{:<16} {:>10.2f} Mops/s {:>8.3f} ns/op   checksum {}",
+        name, 5e3 * rounds / duration, (double) duration / (5 * rounds), checksum
+    ) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [rounds] [checkpoint_interval]\n";
+        return 1;
+    }
+    size_t rounds   = argc > 1 ? std::stoul(argv[1]) : 100000000;
+    size_t interval = argc > 2 ? std::stoul(argv[2]) : 64;
+    std::cout << fmt::format("rounds={} checkpoint_interval={}", rounds, interval) << std::endl;
+    Measure("evmone",       rounds, [&]{ return FlatStack(rounds); });
+    Measure("evmcow<1>",    rounds, [&]{ return CopyOnWriteStack<1>(rounds, interval); });
+    Measure("evmcow<2>",    rounds, [&]{ return CopyOnWriteStack<2>(rounds, interval); });
+    Measure("evmcow<4>",    rounds, [&]{ return CopyOnWriteStack<4>(rounds, interval); });
+    Measure("evmcow<8>",    rounds, [&]{ return CopyOnWriteStack<8>(rounds, interval); });
+    Measure("evmcow<16>",   rounds, [&]{ return CopyOnWriteStack<16>(rounds, interval); });
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <spectrum/common/lock-util.hpp>
+#include <spectrum/common/random.hpp>
+#include <spectrum/transaction/evm-hash.hpp>
+#include <evmc/evmc.hpp>
+#include <fmt/core.h>
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <tuple>
+#include <string>
+
+using namespace std::chrono;
+using namespace spectrum;
+
+using K = std::tuple<evmc::address, evmc::bytes32>;
+
+/// @brief visit and update a table from many threads, alternating reads and writes
+/// @param table the table, empty
+/// @param num_threads the number of threads accessing the table
+/// @param num_keys the number of distinct keys
+/// @param skew the zipf skew of the keys, 0 means uniform
+/// @param duration how long the threads keep running
+/// @return operations per second
+template<typename Table>
+size_t BenchTable(Table&& table, size_t num_threads, size_t num_keys, double skew, milliseconds duration) {
+    auto stop_flag  = std::atomic<bool>{false};
+    auto count      = std::atomic<size_t>{0};
+    auto threads    = std::vector<std::thread>();
+    // sample keys upfront, so the shared generator lock stays out of the measurement
+    auto keys       = std::vector<std::vector<size_t>>(num_threads);
+    for (auto& sample: keys) {
+        auto random = skew == 0.0 ?
+            std::unique_ptr<Random>(new Unif(num_keys)) :
+            std::unique_ptr<Random>(new Zipf(num_keys, skew));
+        sample.resize(1 << 14);
+        for (auto& x: sample) { x = random->Next(); }
+    }
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            auto i = size_t{0};
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                auto k = std::make_tuple(evmc::address{0x1}, evmc::bytes32{keys[t][i % keys[t].size()]});
+                if (i % 2) { table.Visit(k, [](auto& v) {}); }
+                else { table.Update(k, [](auto& v) { v = evmc::bytes32{0x1}; }); }
+                ++i;
+            }
+            count.fetch_add(i);
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    stop_flag.store(true);
+    for (auto& t: threads) { t.join(); }
+    return count.load() * 1000 / duration.count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [num_keys] [duration_ms]\n";
+        return 1;
+    }
+    size_t num_keys = argc > 1 ? std::stoul(argv[1]) : 100000;
+    auto duration   = milliseconds(argc > 2 ? std::stoul(argv[2]) : 100);
+    std::cout << fmt::format("num_keys={} duration={}ms", num_keys, duration.count()) << std::endl;
+    for (auto skew: {0.0, 0.99, 1.5}) {
+        for (auto num_threads: {1, 4, 16, 32}) {
+            std::cout << fmt::format(
+                "skew={:<4} threads={:<2} table={:>10} op/s bucket-table={:>10} op/s",
+                skew, num_threads,
+                BenchTable(Table<K, evmc::bytes32, KeyHasher>(9973), num_threads, num_keys, skew, duration),
+                BenchTable(BucketTable<K, evmc::bytes32, KeyHasher>(num_keys), num_threads, num_keys, skew, duration)
+            ) << std::endl;
+        }
+    }
+    return 0;
+}
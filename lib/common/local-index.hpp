@@ -0,0 +1,156 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+namespace spectrum {
+
+/// @brief a per-transaction index from keys to positions in its get and put logs
+/// @tparam K the key type
+/// @tparam Hasher the key hasher
+template<typename K, typename Hasher>
+class LocalIndex {
+
+    static constexpr uint32_t empty = ~uint32_t{0};
+
+    struct Slot {
+        K           key{};
+        // the first position in the get log, and the latest position in the put log
+        uint32_t    get{empty};
+        uint32_t    put{empty};
+        bool        used{false};
+    };
+
+    private:
+    std::vector<Slot>       slots;
+    size_t                  num_used{0};
+    // the slot of each log position, so truncation can find the keys to roll back
+    std::vector<uint32_t>   gets;
+    std::vector<uint32_t>   puts;
+    // the previous put position of the same key, restored when a put is truncated
+    std::vector<uint32_t>   puts_prev;
+    uint32_t    Locate(const K& k);
+    uint32_t    Probe(const K& k) const;
+    void        Grow();
+
+    public:
+    static constexpr size_t none = ~size_t{0};
+    size_t  FindGet(const K& k) const;
+    size_t  FindPut(const K& k) const;
+    void    PushGet(const K& k);
+    void    PushPut(const K& k);
+    void    TruncateGet(size_t n);
+    void    TruncatePut(size_t n);
+    void    Clear();
+
+};
+
+/// @brief find the slot of a key, or the empty slot where it would be placed
+template<typename K, typename Hasher>
+uint32_t LocalIndex<K, Hasher>::Probe(const K& k) const {
+    auto mask = slots.size() - 1;
+    for (auto i = Hasher()(k) & mask;; i = (i + 1) & mask) {
+        if (!slots[i].used || slots[i].key == k) { return i; }
+    }
+}
+
+/// @brief find or claim the slot of a key
+template<typename K, typename Hasher>
+uint32_t LocalIndex<K, Hasher>::Locate(const K& k) {
+    if ((num_used + 1) * 2 > slots.size()) { Grow(); }
+    auto i = Probe(k);
+    if (!slots[i].used) {
+        slots[i].used = true;
+        slots[i].key  = k;
+        ++num_used;
+    }
+    return i;
+}
+
+/// @brief double the slots and remap logged slot numbers
+template<typename K, typename Hasher>
+void LocalIndex<K, Hasher>::Grow() {
+    auto old = std::move(slots);
+    slots = std::vector<Slot>(std::max(old.size() * 2, size_t{32}));
+    auto remap = std::vector<uint32_t>(old.size());
+    for (size_t i = 0; i < old.size(); ++i) {
+        if (!old[i].used) { continue; }
+        remap[i] = Probe(old[i].key);
+        slots[remap[i]] = std::move(old[i]);
+    }
+    for (auto& x: gets) { x = remap[x]; }
+    for (auto& x: puts) { x = remap[x]; }
+}
+
+/// @brief find the first get of a key
+/// @param k the key
+/// @return the position in the get log, or none
+template<typename K, typename Hasher>
+size_t LocalIndex<K, Hasher>::FindGet(const K& k) const {
+    if (num_used == 0) { return none; }
+    auto& slot = slots[Probe(k)];
+    return slot.used && slot.get != empty ? slot.get : none;
+}
+
+/// @brief find the latest put of a key
+/// @param k the key
+/// @return the position in the put log, or none
+template<typename K, typename Hasher>
+size_t LocalIndex<K, Hasher>::FindPut(const K& k) const {
+    if (num_used == 0) { return none; }
+    auto& slot = slots[Probe(k)];
+    return slot.used && slot.put != empty ? slot.put : none;
+}
+
+/// @brief record a get appended at the end of the get log
+/// @param k the key
+template<typename K, typename Hasher>
+void LocalIndex<K, Hasher>::PushGet(const K& k) {
+    auto i = Locate(k);
+    if (slots[i].get == empty) { slots[i].get = gets.size(); }
+    gets.push_back(i);
+}
+
+/// @brief record a put appended at the end of the put log
+/// @param k the key
+template<typename K, typename Hasher>
+void LocalIndex<K, Hasher>::PushPut(const K& k) {
+    auto i = Locate(k);
+    puts_prev.push_back(slots[i].put);
+    slots[i].put = puts.size();
+    puts.push_back(i);
+}
+
+/// @brief forget gets after the get log is resized
+/// @param n the new size of the get log
+template<typename K, typename Hasher>
+void LocalIndex<K, Hasher>::TruncateGet(size_t n) {
+    for (auto p = gets.size(); p-- > n;) {
+        if (slots[gets[p]].get == p) { slots[gets[p]].get = empty; }
+    }
+    gets.resize(std::min(n, gets.size()));
+}
+
+/// @brief forget puts after the put log is resized
+/// @param n the new size of the put log
+template<typename K, typename Hasher>
+void LocalIndex<K, Hasher>::TruncatePut(size_t n) {
+    for (auto p = puts.size(); p-- > n;) {
+        slots[puts[p]].put = puts_prev[p];
+    }
+    puts.resize(std::min(n, puts.size()));
+    puts_prev.resize(puts.size());
+}
+
+/// @brief forget everything, keeping allocated slots
+template<typename K, typename Hasher>
+void LocalIndex<K, Hasher>::Clear() {
+    for (auto& slot: slots) { slot = Slot{}; }
+    num_used = 0;
+    gets.clear();
+    puts.clear();
+    puts_prev.clear();
+}
+
+} // namespace spectrum
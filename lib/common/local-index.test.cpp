@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <spectrum/common/local-index.hpp>
+#include <functional>
+
+namespace {
+
+using namespace spectrum;
+
+using Index = LocalIndex<size_t, std::hash<size_t>>;
+
+TEST(LocalIndex, FindAfterPush) {
+    auto index = Index();
+    ASSERT_EQ(index.FindGet(1), Index::none);
+    ASSERT_EQ(index.FindPut(1), Index::none);
+    // get log: 1 2 1, put log: 3 1 3
+    index.PushGet(1); index.PushGet(2); index.PushGet(1);
+    index.PushPut(3); index.PushPut(1); index.PushPut(3);
+    ASSERT_EQ(index.FindGet(1), 0);
+    ASSERT_EQ(index.FindGet(2), 1);
+    ASSERT_EQ(index.FindGet(3), Index::none);
+    ASSERT_EQ(index.FindPut(3), 2);
+    ASSERT_EQ(index.FindPut(1), 1);
+    ASSERT_EQ(index.FindPut(2), Index::none);
+}
+
+TEST(LocalIndex, Truncate) {
+    auto index = Index();
+    // enough keys to grow several times
+    for (size_t i = 0; i < 1000; ++i) { index.PushGet(i); index.PushPut(i % 10); }
+    index.TruncatePut(15);
+    // puts 10..14 are the second writes on keys 0..4
+    for (size_t k = 0; k < 5; ++k) { ASSERT_EQ(index.FindPut(k), k + 10); }
+    for (size_t k = 5; k < 10; ++k) { ASSERT_EQ(index.FindPut(k), k); }
+    index.TruncatePut(3);
+    ASSERT_EQ(index.FindPut(2), 2);
+    ASSERT_EQ(index.FindPut(3), Index::none);
+    index.TruncateGet(500);
+    ASSERT_EQ(index.FindGet(499), 499);
+    ASSERT_EQ(index.FindGet(500), Index::none);
+    // re-pushing a truncated key lands at the end of the log
+    index.PushGet(700);
+    ASSERT_EQ(index.FindGet(700), 500);
+    index.Clear();
+    ASSERT_EQ(index.FindGet(1), Index::none);
+    ASSERT_EQ(index.FindPut(1), Index::none);
+}
+
+}
@@ -0,0 +1,3 @@
+#include <spectrum/common/lock-util.hpp>
+
+DEFINE_bool(bucket_table, true, "back the data tables of aria, calvin and dummy with BucketTable instead of the partitioned Table");
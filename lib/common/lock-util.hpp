@@ -1,13 +1,25 @@
 #pragma once
 #include <memory>
+#include <algorithm>
 #include <queue>
 #include <vector>
 #include <atomic>
 #include <unordered_map>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <cstring>
+#include <bit>
+#include <optional>
 #include <evmc/evmc.hpp>
 #include <glog/logging.h>
+#include <spectrum/common/topology.hpp>
+#include <spectrum/common/wait-util.hpp>
+#include <gflags/gflags.h>
 #include <vector>
 
+DECLARE_bool(bucket_table);
+
 namespace spectrum {
 
 #define TP std::unique_ptr<T>
@@ -19,7 +31,10 @@ class SpinLock {
 
     public:
     void Lock() {
-        while(flag.test_and_set(std::memory_order_acquire)) {}
+        while(flag.test_and_set(std::memory_order_acquire)) {
+            // spin on a plain read, so waiting cores don't bounce the cache line
+            while (flag.test(std::memory_order_relaxed)) { CpuRelax(); }
+        }
     }
     void Unlock() {
         flag.clear(std::memory_order_release);
@@ -50,9 +65,9 @@ class LockQueue {
     TP Pop() {
         auto guard = Guard{mu};
         if (!queue.size()) return {nullptr};
-        auto tx = const_cast<TP&>(queue.top()).release();
+        auto tx = std::move(queue.front());
         queue.pop();
-        return std::unique_ptr<T>(tx);
+        return tx;
     }
     void Push(TP&& tx) {
         auto guard = Guard{mu};
@@ -95,46 +110,616 @@ class LockPriorityQueue {
 
 };
 
+/// @brief a lock-free multi-producer multi-consumer queue popping transactions roughly by id
+/// @tparam T the transaction type, which must expose an `id` field
+template<typename T>
+class RingPriorityQueue {
+
+    // transaction i lives in slot i % capacity, pop scans occupied slots upwards from the head hint.
+    // ids outside [head, head + capacity) or colliding on a slot go to a locked overflow queue.
+
+    private:
+    size_t  capacity;
+    std::unique_ptr<std::atomic<T*>[]>          slots;
+    // set after a slot is filled, and cleared by the only popper that may claim the slot
+    std::unique_ptr<std::atomic<uint64_t>[]>    occupied;
+    std::atomic<size_t>     head{0};
+    std::atomic<size_t>     size{0};
+    std::atomic<size_t>     overflow_size{0};
+    LockPriorityQueue<T>    overflow;
+    TP PopRing();
+
+    public:
+    RingPriorityQueue(size_t capacity = 1024):
+        capacity{(capacity + 63) / 64 * 64},
+        slots{new std::atomic<T*>[this->capacity]{}},
+        occupied{new std::atomic<uint64_t>[this->capacity / 64]{}}
+    {}
+    ~RingPriorityQueue() {
+        for (size_t i = 0; i < capacity; ++i) { delete slots[i].load(); }
+    }
+    /// @brief push a transaction
+    /// @param tx the transaction, moved into the queue
+    void Push(TP&& tx) {
+        auto id = tx->id;
+        auto h  = head.load(std::memory_order_relaxed);
+        while (id < h && !head.compare_exchange_weak(h, id, std::memory_order_relaxed)) {}
+        h = std::min(h, id);
+        size.fetch_add(1, std::memory_order_relaxed);
+        auto expected = (T*) nullptr;
+        if (id < h + capacity && slots[id % capacity].compare_exchange_strong(expected, tx.get(), std::memory_order_release)) {
+            tx.release();
+            occupied[id % capacity / 64].fetch_or(uint64_t{1} << (id % 64), std::memory_order_release);
+            return;
+        }
+        overflow_size.fetch_add(1, std::memory_order_relaxed);
+        overflow.Push(std::move(tx));
+    }
+    /// @brief pop the transaction with roughly the smallest id
+    /// @return the transaction, or nullptr if the queue looks empty
+    TP Pop() {
+        if (size.load(std::memory_order_relaxed) == 0) { return {nullptr}; }
+        auto tx = PopRing();
+        if (overflow_size.load(std::memory_order_relaxed) != 0) {
+            if (auto other = overflow.Pop()) {
+                overflow_size.fetch_sub(1, std::memory_order_relaxed);
+                size.fetch_sub(1, std::memory_order_relaxed);
+                if (tx == nullptr || other->id < tx->id) { std::swap(tx, other); }
+                if (other != nullptr) { Push(std::move(other)); }
+            }
+        }
+        return tx;
+    }
+    size_t Size() {
+        return size.load(std::memory_order_relaxed);
+    }
+
+};
+
+/// @brief claim the first occupied slot at or after the head hint, wrapping around once
+template<typename T>
+TP RingPriorityQueue<T>::PopRing() {
+    auto h      = head.load(std::memory_order_relaxed);
+    auto words  = capacity / 64;
+    auto start  = h % capacity;
+    for (size_t j = 0; j <= words; ++j) {
+        auto w      = (start / 64 + j) % words;
+        auto mask   = occupied[w].load(std::memory_order_relaxed);
+        if (j == 0)     { mask &= ~uint64_t{0} << (start % 64); }
+        if (j == words) { mask &= (uint64_t{1} << (start % 64)) - 1; }
+        while (mask) {
+            auto i   = w * 64 + std::countr_zero(mask);
+            auto bit = uint64_t{1} << (i % 64);
+            mask &= mask - 1;
+            if (!(occupied[w].fetch_and(~bit, std::memory_order_acquire) & bit)) { continue; }
+            auto tx = TP(slots[i].exchange(nullptr, std::memory_order_acquire));
+            if (tx == nullptr) { continue; }
+            size.fetch_sub(1, std::memory_order_relaxed);
+            // slots below the popped one were empty, so move the scan start up
+            if (tx->id > h) { head.compare_exchange_strong(h, tx->id, std::memory_order_relaxed); }
+            return tx;
+        }
+    }
+    return {nullptr};
+}
+
+/// @brief a bounded single-producer single-consumer ring
+/// @tparam V the value type
+template<typename V>
+class SPSCRing {
+
+    private:
+    size_t  capacity;
+    std::unique_ptr<std::optional<V>[]>     slots;
+    // each side owns one index and caches the other one, so the common case reads no shared line
+    alignas(64) std::atomic<size_t>     head{0};
+    size_t                              cached_tail{0};
+    alignas(64) std::atomic<size_t>     tail{0};
+    size_t                              cached_head{0};
+
+    public:
+    SPSCRing(size_t capacity):
+        capacity{capacity},
+        slots{new std::optional<V>[capacity]}
+    {}
+    /// @brief push a value, only called by the producer
+    /// @param value the value, left untouched if the ring is full
+    /// @return if the value is pushed
+    bool TryPush(V&& value) {
+        auto t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head == capacity) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head == capacity) { return false; }
+        }
+        slots[t % capacity].emplace(std::move(value));
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    /// @brief pop a value, only called by the consumer
+    /// @return the value, or nothing if the ring is empty
+    std::optional<V> TryPop() {
+        auto h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail) { return std::nullopt; }
+        }
+        auto value = std::move(slots[h % capacity]);
+        slots[h % capacity].reset();
+        head.store(h + 1, std::memory_order_release);
+        return value;
+    }
+
+};
+
+/// @brief a lock-free ring of parked transactions, where transaction i can only park in slot i % capacity
+/// @tparam T the transaction type, which must expose a dense `id` field
+template<typename T>
+class ParkingRing {
+
+    // a parked transaction is never finalized, so the frontier never passes it.
+    // only parking ids below frontier + capacity thus keeps one id per slot, and claims need no id check.
+
+    private:
+    size_t  capacity;
+    std::unique_ptr<std::atomic<T*>[]>          slots;
+    // slots whose transaction may have to re-execute, so scanners never dereference unclaimed transactions
+    std::unique_ptr<std::atomic<uint64_t>[]>    flags;
+
+    public:
+    ParkingRing(size_t capacity):
+        capacity{capacity},
+        slots{new std::atomic<T*>[capacity]{}},
+        flags{new std::atomic<uint64_t>[(capacity + 63) / 64]{}}
+    {}
+    ~ParkingRing() {
+        for (size_t i = 0; i < capacity; ++i) { delete slots[i].load(); }
+    }
+    size_t Capacity() const { return capacity; }
+    /// @brief park a transaction, leaving it to whoever claims it next
+    /// @param tx the transaction, reset to null if parked
+    /// @param frontier the smallest unfinalized id
+    /// @return if the transaction is parked
+    bool Park(TP& tx, size_t frontier) {
+        if (tx->id >= frontier + capacity) { return false; }
+        auto expected = (T*) nullptr;
+        if (!slots[tx->id % capacity].compare_exchange_strong(expected, tx.get(), std::memory_order_release)) {
+            return false;
+        }
+        tx.release();
+        return true;
+    }
+    /// @brief claim a parked transaction by id
+    /// @param id an id at least the frontier
+    /// @return the transaction, or nullptr if it isn't parked
+    TP Take(size_t id) {
+        auto& slot = slots[id % capacity];
+        if (slot.load(std::memory_order_relaxed) == nullptr) { return {nullptr}; }
+        return TP(slot.exchange(nullptr, std::memory_order_acquire));
+    }
+    /// @brief mark the transaction with this id as possibly having to re-execute
+    void Flag(size_t id) {
+        auto i = id % capacity;
+        flags[i / 64].fetch_or(uint64_t{1} << (i % 64), std::memory_order_release);
+    }
+    /// @brief claim a flagged transaction, scanning ids from lowest to highest
+    /// @param frontier the smallest unfinalized id
+    /// @return the transaction, or nullptr if no flagged transaction is parked
+    TP TakeFlagged(size_t frontier) {
+        for (size_t k = 0; k < capacity; ++k) {
+            auto i = (frontier + k) % capacity;
+            auto bit = uint64_t{1} << (i % 64);
+            if (!(flags[i / 64].load(std::memory_order_relaxed) & bit)) { continue; }
+            flags[i / 64].fetch_and(~bit, std::memory_order_acquire);
+            if (slots[i].load(std::memory_order_relaxed) == nullptr) { continue; }
+            if (auto tx = TP(slots[i].exchange(nullptr, std::memory_order_acquire))) { return tx; }
+        }
+        return {nullptr};
+    }
+    /// @brief check if any slot is flagged
+    bool HasFlagged() const {
+        for (size_t w = 0; w < (capacity + 63) / 64; ++w) {
+            if (flags[w].load(std::memory_order_relaxed)) { return true; }
+        }
+        return false;
+    }
+    /// @brief check if a transaction is parked under this id
+    bool Parked(size_t id) const {
+        return slots[id % capacity].load(std::memory_order_relaxed) != nullptr;
+    }
+
+};
+
 #undef TP
 
 template<typename K, typename V, typename Hasher>
 class Table {
 
     private:
+    // a partition lock and its counters of lock acquisitions and local/remote accesses
+    // counters are only written while holding the lock, so they ride on the cache line the lock already owns
+    struct alignas(64) Latch {
+        SpinLock                lock;
+        std::atomic<size_t>     acquisitions{0};
+        std::atomic<size_t>     local_accesses{0};
+        std::atomic<size_t>     remote_accesses{0};
+    };
     size_t                  num_partitions;
-    std::vector<SpinLock>   locks;
-    std::vector<std::unordered_map<K, V, Hasher>> partitions;
+    std::vector<Latch>      latches;
+    void Acquired(size_t partition_id);
+    // with numa placement, partition i lives on node i % num_nodes
+    bool                    numa;
+    size_t                  num_nodes;
+    std::vector<std::unique_ptr<std::pmr::memory_resource>> upstreams;
+    // each partition allocates its nodes and version buffers from its own pool, guarded by its lock
+    std::vector<std::unique_ptr<std::pmr::unsynchronized_pool_resource>> arenas;
+    std::vector<std::pmr::unordered_map<K, V, Hasher>> partitions;
 
     public:
     Table(size_t partitions);
-    void Get(const K& k, std::function<void(const V& v)>&& vmap);
-    void Put(const K& k, std::function<void(V& v)>&& vmap);
+    template<typename F>
+    void Visit(const K& k, F&& vmap);
+    template<typename F>
+    void Update(const K& k, F&& vmap);
+    template<typename I, typename P, typename F>
+    void UpdateBatch(std::vector<I>& items, P&& key, F&& vmap);
+    size_t CountLocks() const;
+    size_t CountLocalAccesses() const;
+    size_t CountRemoteAccesses() const;
 
 };
 
 template<typename K, typename V, typename Hasher>
 Table<K, V, Hasher>::Table(size_t partitions)
-    : locks(partitions),
-      partitions(partitions),
-      num_partitions{partitions}
-{}
+    : num_partitions{partitions},
+      latches(partitions),
+      numa{FLAGS_numa},
+      num_nodes{FLAGS_numa ? Topology::Get().NumNodes() : 1}
+{
+    this->arenas.reserve(partitions);
+    this->partitions.reserve(partitions);
+    for (size_t i = 0; i < partitions; ++i) {
+        if (numa) {
+            this->upstreams.emplace_back(new NodeResource(Topology::Get().NodeId(i % num_nodes)));
+            this->arenas.emplace_back(new std::pmr::unsynchronized_pool_resource(this->upstreams.back().get()));
+        }
+        else {
+            this->arenas.emplace_back(new std::pmr::unsynchronized_pool_resource());
+        }
+        this->partitions.emplace_back(0, Hasher(), std::equal_to<K>(), this->arenas.back().get());
+    }
+}
 
+/// @brief count an acquisition of a partition lock
+/// @param partition_id the partition whose lock is held
 template<typename K, typename V, typename Hasher>
-void Table<K, V, Hasher>::Get(const K& k, std::function<void(const V& v)>&& vmap) {
+void Table<K, V, Hasher>::Acquired(size_t partition_id) {
+    auto bump = [](std::atomic<size_t>& count) {
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    };
+    auto& latch = latches[partition_id];
+    bump(latch.acquisitions);
+    if (!numa) { return; }
+    bump(Topology::CurrentNode() == partition_id % num_nodes ? latch.local_accesses : latch.remote_accesses);
+}
+
+/// @brief the total number of partition lock acquisitions
+/// @return the sum over all partitions
+template<typename K, typename V, typename Hasher>
+size_t Table<K, V, Hasher>::CountLocks() const {
+    auto sum = size_t{0};
+    for (auto& latch: latches) { sum += latch.acquisitions.load(std::memory_order_relaxed); }
+    return sum;
+}
+
+/// @brief the number of accesses from threads on the home node of a partition
+/// @return the sum over all partitions, always zero without numa placement
+template<typename K, typename V, typename Hasher>
+size_t Table<K, V, Hasher>::CountLocalAccesses() const {
+    auto sum = size_t{0};
+    for (auto& latch: latches) { sum += latch.local_accesses.load(std::memory_order_relaxed); }
+    return sum;
+}
+
+/// @brief the number of accesses from threads on other nodes than the home node of a partition
+/// @return the sum over all partitions, always zero without numa placement
+template<typename K, typename V, typename Hasher>
+size_t Table<K, V, Hasher>::CountRemoteAccesses() const {
+    auto sum = size_t{0};
+    for (auto& latch: latches) { sum += latch.remote_accesses.load(std::memory_order_relaxed); }
+    return sum;
+}
+
+/// @brief read the value of a key if it exists
+/// @param k the key
+/// @param vmap the callback receiving a const reference to the value
+template<typename K, typename V, typename Hasher>
+template<typename F>
+void Table<K, V, Hasher>::Visit(const K& k, F&& vmap) {
     auto partition_id = ((size_t)Hasher()(k)) % num_partitions;
     DLOG(INFO) << "at partition " << partition_id;
-    auto guard = Guard{locks[partition_id]};
+    auto guard = Guard{latches[partition_id].lock};
+    Acquired(partition_id);
     auto& partition = this->partitions[partition_id];
-    if (partition.contains(k)) vmap(partition[k]);
+    auto it = partition.find(k);
+    if (it != partition.end()) vmap(std::as_const(it->second));
 }
 
+/// @brief update the value of a key, default-inserting it if it doesn't exist
+/// @param k the key
+/// @param vmap the callback receiving a mutable reference to the value
 template<typename K, typename V, typename Hasher>
-void Table<K, V, Hasher>::Put(const K& k, std::function<void(V& v)>&& vmap) {
+template<typename F>
+void Table<K, V, Hasher>::Update(const K& k, F&& vmap) {
     auto partition_id = ((size_t)Hasher()(k)) % num_partitions;
     DLOG(INFO) << "at partition " << partition_id;
-    auto guard = Guard{locks[partition_id]};
+    auto guard = Guard{latches[partition_id].lock};
+    Acquired(partition_id);
     auto& partition = this->partitions[partition_id];
     vmap(partition[k]);
 }
 
+/// @brief update the values of many keys, taking each partition lock only once
+/// @param items the items to apply, stably reordered by partition in place, so items on the same key keep their order
+/// @param key the projection from an item to its key
+/// @param vmap the callback receiving an item and a mutable reference to its value
+template<typename K, typename V, typename Hasher>
+template<typename I, typename P, typename F>
+void Table<K, V, Hasher>::UpdateBatch(std::vector<I>& items, P&& key, F&& vmap) {
+    auto partition_of = [&](const I& item) {
+        return ((size_t)Hasher()(key(item))) % num_partitions;
+    };
+    std::stable_sort(items.begin(), items.end(), [&](const I& a, const I& b) {
+        return partition_of(a) < partition_of(b);
+    });
+    for (size_t i = 0; i < items.size();) {
+        auto partition_id = partition_of(items[i]);
+        auto guard = Guard{latches[partition_id].lock};
+        Acquired(partition_id);
+        auto& partition = this->partitions[partition_id];
+        for (; i < items.size() && partition_of(items[i]) == partition_id; ++i) {
+            vmap(items[i], partition[key(items[i])]);
+        }
+    }
+}
+
+template<typename K, typename V, typename Hasher>
+class BucketTable {
+
+    // a slot is claimed once and never freed, so the key is immutable after `used` is set
+    struct Slot {
+        // seqlock version, odd while a writer holds the slot
+        std::atomic<uint64_t>   seq{0};
+        std::atomic<bool>       used{false};
+        K                       key{};
+        V                       value{};
+    };
+
+    // keys never move, a full probe window spills into a larger chained level instead of rehashing
+    struct Level {
+        size_t                  mask;
+        // the top bits of a mixed hash pick the first slot of the probe window
+        size_t                  shift;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<Level*>     next{nullptr};
+        Level(size_t capacity):
+            mask{capacity - 1},
+            shift{(size_t) (64 - std::countr_zero(capacity))},
+            slots{new Slot[capacity]}
+        {}
+        ~Level() { delete next.load(); }
+    };
+
+    static constexpr size_t max_probe = 16;
+    static constexpr size_t growth    = 4;
+    // the first level size when the caller has no idea how many keys will come
+    static constexpr size_t default_capacity = 1 << 16;
+
+    private:
+    Level   root;
+    Slot*   Find(const K& k);
+    Slot*   FindOrInsert(const K& k);
+    Level*  Next(Level* level);
+    // the low bits of the product only depend on the low bits of the hash, so slots come from the high bits
+    static uint64_t Mix(size_t h) { return (uint64_t) h * 0x9e3779b97f4a7c15ull; }
+    static void Lock(Slot& slot);
+    static void Unlock(Slot& slot) { slot.seq.fetch_add(1, std::memory_order_release); }
+
+    public:
+    BucketTable(size_t capacity);
+    template<typename F>
+    void Visit(const K& k, F&& vmap);
+    template<typename F>
+    void Update(const K& k, F&& vmap);
+    size_t CountLevels() const;
+
+};
+
+/// @brief initialize a bucket table
+/// @param capacity the expected number of keys, 0 if unknown, the first level holds twice as many slots
+template<typename K, typename V, typename Hasher>
+BucketTable<K, V, Hasher>::BucketTable(size_t capacity):
+    root{std::bit_ceil(std::max(capacity == 0 ? default_capacity : capacity, max_probe) * 2)}
+{}
+
+template<typename K, typename V, typename Hasher>
+void BucketTable<K, V, Hasher>::Lock(Slot& slot) {
+    while (true) {
+        auto seq = slot.seq.load(std::memory_order_relaxed);
+        if (seq & 1) { CpuRelax(); continue; }
+        if (!slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire)) { CpuRelax(); continue; }
+        // publish the odd version before any write to the value
+        std::atomic_thread_fence(std::memory_order_release);
+        return;
+    }
+}
+
+/// @brief get the level after the given one, allocating it if it doesn't exist
+template<typename K, typename V, typename Hasher>
+typename BucketTable<K, V, Hasher>::Level* BucketTable<K, V, Hasher>::Next(Level* level) {
+    auto next = level->next.load(std::memory_order_acquire);
+    if (next != nullptr) { return next; }
+    auto fresh = new Level((level->mask + 1) * growth);
+    if (level->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel)) { return fresh; }
+    delete fresh;
+    return next;
+}
+
+/// @brief locate the slot holding a key
+/// @return the slot, or nullptr if the key was never inserted
+template<typename K, typename V, typename Hasher>
+typename BucketTable<K, V, Hasher>::Slot* BucketTable<K, V, Hasher>::Find(const K& k) {
+    auto h = Mix(Hasher()(k));
+    for (auto level = &root; level != nullptr; level = level->next.load(std::memory_order_acquire)) {
+        for (size_t i = 0; i < max_probe; ++i) {
+            auto& slot = level->slots[((h >> level->shift) + i) & level->mask];
+            // slots are filled in probe order, an empty slot ends the search
+            if (!slot.used.load(std::memory_order_acquire)) { return nullptr; }
+            if (slot.key == k) { return &slot; }
+        }
+    }
+    return nullptr;
+}
+
+/// @brief locate the slot holding a key, claiming a fresh slot if the key is absent
+template<typename K, typename V, typename Hasher>
+typename BucketTable<K, V, Hasher>::Slot* BucketTable<K, V, Hasher>::FindOrInsert(const K& k) {
+    auto h = Mix(Hasher()(k));
+    for (auto level = &root;; level = Next(level)) {
+        for (size_t i = 0; i < max_probe; ++i) {
+            auto& slot = level->slots[((h >> level->shift) + i) & level->mask];
+            if (!slot.used.load(std::memory_order_acquire)) {
+                // racing inserts of the same key all stop at this slot, the first one claims it
+                Lock(slot);
+                if (!slot.used.load(std::memory_order_relaxed)) {
+                    slot.key = k;
+                    slot.used.store(true, std::memory_order_release);
+                    Unlock(slot);
+                    return &slot;
+                }
+                Unlock(slot);
+            }
+            if (slot.key == k) { return &slot; }
+        }
+    }
+}
+
+/// @brief the number of levels keys have spilled into, including the first one
+template<typename K, typename V, typename Hasher>
+size_t BucketTable<K, V, Hasher>::CountLevels() const {
+    auto count = size_t{0};
+    for (auto level = &root; level != nullptr; level = level->next.load(std::memory_order_acquire)) { ++count; }
+    return count;
+}
+
+/// @brief read the value of a key if it exists
+/// @param k the key
+/// @param vmap the callback receiving a const reference to the value
+template<typename K, typename V, typename Hasher>
+template<typename F>
+void BucketTable<K, V, Hasher>::Visit(const K& k, F&& vmap) {
+    auto slot = Find(k);
+    if (slot == nullptr) { return; }
+    if constexpr (std::is_trivially_copyable_v<V>) {
+        // optimistic read, retry if a writer held or changed the slot in between
+        auto value = V{};
+        while (true) {
+            auto seq = slot->seq.load(std::memory_order_acquire);
+            if (seq & 1) { CpuRelax(); continue; }
+            std::memcpy((void*) &value, (const void*) &slot->value, sizeof(V));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->seq.load(std::memory_order_relaxed) == seq) { break; }
+            CpuRelax();
+        }
+        vmap(std::as_const(value));
+    }
+    else {
+        Lock(*slot);
+        vmap(std::as_const(slot->value));
+        Unlock(*slot);
+    }
+}
+
+/// @brief update the value of a key, default-inserting it if it doesn't exist
+/// @param k the key
+/// @param vmap the callback receiving a mutable reference to the value
+template<typename K, typename V, typename Hasher>
+template<typename F>
+void BucketTable<K, V, Hasher>::Update(const K& k, F&& vmap) {
+    auto slot = FindOrInsert(k);
+    Lock(*slot);
+    vmap(slot->value);
+    Unlock(*slot);
+}
+
+/// @brief a table on either backend, picked when it is constructed, so one protocol can be measured on both
+template<typename K, typename V, typename Hasher>
+class SwitchTable {
+
+    private:
+    std::unique_ptr<Table<K, V, Hasher>>        table;
+    std::unique_ptr<BucketTable<K, V, Hasher>>  bucket_table;
+
+    public:
+    SwitchTable(bool bucket, size_t partitions, size_t capacity);
+    template<typename F>
+    void Visit(const K& k, F&& vmap);
+    template<typename F>
+    void Update(const K& k, F&& vmap);
+    size_t CountLocks() const;
+    size_t CountLocalAccesses() const;
+    size_t CountRemoteAccesses() const;
+
+};
+
+/// @brief initialize a table on one of the backends
+/// @param bucket use a BucketTable if true, and a partitioned Table otherwise
+/// @param partitions the number of partitions of the partitioned Table
+/// @param capacity the expected number of keys of the BucketTable, 0 if unknown
+template<typename K, typename V, typename Hasher>
+SwitchTable<K, V, Hasher>::SwitchTable(bool bucket, size_t partitions, size_t capacity) {
+    if (bucket) { bucket_table.reset(new BucketTable<K, V, Hasher>(capacity)); }
+    else        { table.reset(new Table<K, V, Hasher>(partitions)); }
+}
+
+/// @brief read the value of a key if it exists
+/// @param k the key
+/// @param vmap the callback receiving a const reference to the value
+template<typename K, typename V, typename Hasher>
+template<typename F>
+void SwitchTable<K, V, Hasher>::Visit(const K& k, F&& vmap) {
+    if (bucket_table) { bucket_table->Visit(k, std::forward<F>(vmap)); }
+    else              { table->Visit(k, std::forward<F>(vmap)); }
+}
+
+/// @brief update the value of a key, default-inserting it if it doesn't exist
+/// @param k the key
+/// @param vmap the callback receiving a mutable reference to the value
+template<typename K, typename V, typename Hasher>
+template<typename F>
+void SwitchTable<K, V, Hasher>::Update(const K& k, F&& vmap) {
+    if (bucket_table) { bucket_table->Update(k, std::forward<F>(vmap)); }
+    else              { table->Update(k, std::forward<F>(vmap)); }
+}
+
+/// @brief the total number of partition lock acquisitions
+/// @return the sum over all partitions, always zero on the bucket backend, which has no partition locks
+template<typename K, typename V, typename Hasher>
+size_t SwitchTable<K, V, Hasher>::CountLocks() const {
+    return table ? table->CountLocks() : 0;
+}
+
+/// @brief the number of accesses from threads on the home node of a partition
+/// @return the sum over all partitions, always zero on the bucket backend, which is not placed by node
+template<typename K, typename V, typename Hasher>
+size_t SwitchTable<K, V, Hasher>::CountLocalAccesses() const {
+    return table ? table->CountLocalAccesses() : 0;
+}
+
+/// @brief the number of accesses from threads on other nodes than the home node of a partition
+/// @return the sum over all partitions, always zero on the bucket backend, which is not placed by node
+template<typename K, typename V, typename Hasher>
+size_t SwitchTable<K, V, Hasher>::CountRemoteAccesses() const {
+    return table ? table->CountRemoteAccesses() : 0;
+}
+
 } // namespace spectrum
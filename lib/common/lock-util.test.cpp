@@ -4,6 +4,8 @@
 #include <spectrum/common/hex.hpp>
 #include <evmc/evmc.hpp>
 #include <span>
+#include <random>
+#include <thread>
 #include <spectrum/common/glog-prefix.hpp>
 
 namespace {
@@ -14,10 +16,187 @@ TEST(Table, Operations) {
     google::InstallPrefixFormatter(PrefixFormatter);
     auto table = spectrum::Table<std::tuple<evmc::address, evmc::bytes32>, evmc::bytes32, KeyHasher>(20);
     auto k = std::make_tuple(evmc::address{0x1}, evmc::bytes32{0x2});
-    table.Put(k, [](evmc::bytes32& v) { v = evmc::bytes32{0x100}; });
+    table.Update(k, [](evmc::bytes32& v) { v = evmc::bytes32{0x100}; });
     auto v = evmc::bytes32{0};
-    table.Get(k, [&](auto _v) { v = _v; });
+    table.Visit(k, [&](auto _v) { v = _v; });
     ASSERT_EQ(spectrum::to_hex(std::span{(uint8_t*)&v, 32}), "0000000000000000000000000000000000000000000000000000000000000100");
 }
 
+TEST(Table, UpdateBatch) {
+    auto table = spectrum::Table<size_t, size_t, std::hash<size_t>>(7);
+    auto items = std::vector<std::pair<size_t, size_t>>();
+    // every key appears twice, so both updates must land on the same value
+    for (size_t i = 0; i < 100; ++i) { items.push_back({i % 50, i}); }
+    table.UpdateBatch(items, [](auto& item) { return item.first; }, [](auto& item, size_t& v) { v += item.second; });
+    for (size_t k = 0; k < 50; ++k) {
+        auto v = size_t{0};
+        table.Visit(k, [&](auto _v) { v = _v; });
+        ASSERT_EQ(v, k + k + 50);
+    }
+}
+
+TEST(Table, BatchLockCount) {
+    // a transaction-like write set of 16 keys over 32 partitions
+    auto single  = spectrum::Table<size_t, size_t, std::hash<size_t>>(32);
+    auto batched = spectrum::Table<size_t, size_t, std::hash<size_t>>(32);
+    auto rng     = std::mt19937_64(42);
+    for (size_t tx = 0; tx < 1000; ++tx) {
+        auto keys = std::vector<size_t>();
+        for (size_t i = 0; i < 16; ++i) { keys.push_back(rng() % 1000); }
+        for (auto k: keys) { single.Update(k, [&](size_t& v) { v = tx; }); }
+        batched.UpdateBatch(keys, [](size_t k) { return k; }, [&](size_t, size_t& v) { v = tx; });
+    }
+    ASSERT_EQ(single.CountLocks(), 16000);
+    ASSERT_LT(batched.CountLocks(), single.CountLocks());
+}
+
+TEST(Table, UpdateBatchKeepsOrder) {
+    auto table = spectrum::Table<size_t, size_t, std::hash<size_t>>(4);
+    auto items = std::vector<std::pair<size_t, size_t>>();
+    for (size_t i = 0; i < 64; ++i) { items.push_back({i % 8, i}); }
+    table.UpdateBatch(items, [](auto& item) { return item.first; }, [](auto& item, size_t& v) { v = item.second; });
+    for (size_t k = 0; k < 8; ++k) {
+        auto v = size_t{0};
+        table.Visit(k, [&](auto _v) { v = _v; });
+        ASSERT_EQ(v, 56 + k);
+    }
+}
+
+struct QueueTx { size_t id; };
+
+TEST(RingPriorityQueue, PopInOrder) {
+    auto queue = RingPriorityQueue<QueueTx>(64);
+    // 70 and 6 collide on a slot, 200 is past the window, both overflow
+    for (auto id: {5, 3, 70, 9, 6, 200, 4}) { queue.Push(std::make_unique<QueueTx>(QueueTx{(size_t) id})); }
+    ASSERT_EQ(queue.Size(), 7);
+    for (auto id: {3, 4, 5, 6, 9, 70, 200}) { ASSERT_EQ(queue.Pop()->id, id); }
+    ASSERT_EQ(queue.Size(), 0);
+    ASSERT_TRUE(queue.Pop() == nullptr);
+    // a smaller id pushed later still comes first
+    queue.Push(std::make_unique<QueueTx>(QueueTx{300}));
+    queue.Push(std::make_unique<QueueTx>(QueueTx{250}));
+    ASSERT_EQ(queue.Pop()->id, 250);
+    ASSERT_EQ(queue.Pop()->id, 300);
+}
+
+TEST(RingPriorityQueue, ConcurrentNoLoss) {
+    auto queue = RingPriorityQueue<QueueTx>(256);
+    auto sum   = std::atomic<size_t>{0};
+    auto threads = std::vector<std::thread>();
+    for (size_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t]{
+            for (size_t i = 0; i < 10000; ++i) {
+                queue.Push(std::make_unique<QueueTx>(QueueTx{t * 10000 + i}));
+                if (auto tx = queue.Pop()) { sum.fetch_add(tx->id); }
+            }
+        });
+    }
+    for (auto& t: threads) { t.join(); }
+    while (auto tx = queue.Pop()) { sum.fetch_add(tx->id); }
+    ASSERT_EQ(sum.load(), size_t{80000} * 79999 / 2);
+    ASSERT_EQ(queue.Size(), 0);
+}
+
+TEST(SPSCRing, FifoAcrossThreads) {
+    auto ring = SPSCRing<std::unique_ptr<size_t>>(16);
+    auto value = std::make_unique<size_t>(0);
+    for (size_t i = 0; i < 16; ++i) { ASSERT_TRUE(ring.TryPush(std::make_unique<size_t>(i))); }
+    // a full ring leaves the value to the caller
+    ASSERT_FALSE(ring.TryPush(std::move(value)));
+    ASSERT_TRUE(value != nullptr);
+    for (size_t i = 0; i < 16; ++i) { ASSERT_EQ(**ring.TryPop(), i); }
+    ASSERT_FALSE(ring.TryPop().has_value());
+    auto producer = std::thread([&]{
+        for (size_t i = 0; i < 10000; ++i) {
+            auto x = std::make_unique<size_t>(i);
+            while (!ring.TryPush(std::move(x))) { std::this_thread::yield(); }
+        }
+    });
+    for (size_t i = 0; i < 10000; ) {
+        if (auto x = ring.TryPop()) { ASSERT_EQ(**x, i); ++i; }
+        else { std::this_thread::yield(); }
+    }
+    producer.join();
+}
+
+TEST(ParkingRing, ParkTakeFlag) {
+    struct Tx { size_t id; };
+    auto ring = ParkingRing<Tx>(4);
+    auto tx = std::make_unique<Tx>(Tx{3});
+    // ids past the window cannot park
+    auto far = std::make_unique<Tx>(Tx{5});
+    ASSERT_FALSE(ring.Park(far, 1));
+    ASSERT_TRUE(far != nullptr);
+    ASSERT_TRUE(ring.Park(tx, 1));
+    ASSERT_TRUE(tx == nullptr);
+    ASSERT_TRUE(ring.Parked(3));
+    ASSERT_FALSE(ring.HasFlagged());
+    ASSERT_TRUE(ring.TakeFlagged(1) == nullptr);
+    ring.Flag(3);
+    ASSERT_TRUE(ring.HasFlagged());
+    tx = ring.TakeFlagged(1);
+    ASSERT_EQ(tx->id, 3);
+    ASSERT_FALSE(ring.HasFlagged());
+    ASSERT_FALSE(ring.Parked(3));
+    ASSERT_TRUE(ring.Take(3) == nullptr);
+    // leftovers are freed with the ring
+    ASSERT_TRUE(ring.Park(tx, 2));
+    ASSERT_TRUE(ring.Park(far, 2));
+    ASSERT_EQ(ring.Take(5)->id, 5);
+}
+
+TEST(BucketTable, Operations) {
+    auto table = spectrum::BucketTable<std::tuple<evmc::address, evmc::bytes32>, evmc::bytes32, KeyHasher>(20);
+    auto k = std::make_tuple(evmc::address{0x1}, evmc::bytes32{0x2});
+    auto v = evmc::bytes32{0};
+    auto found = false;
+    table.Visit(k, [&](auto _v) { found = true; });
+    ASSERT_FALSE(found);
+    table.Update(k, [](evmc::bytes32& v) { v = evmc::bytes32{0x100}; });
+    table.Visit(k, [&](auto _v) { v = _v; found = true; });
+    ASSERT_TRUE(found);
+    ASSERT_EQ(spectrum::to_hex(std::span{(uint8_t*)&v, 32}), "0000000000000000000000000000000000000000000000000000000000000100");
+}
+
+TEST(BucketTable, WeakLowBits) {
+    // identity hashes sharing their low bits must still spread over the first level
+    auto table = spectrum::BucketTable<size_t, size_t, std::hash<size_t>>(1024);
+    for (size_t i = 0; i < 1024; ++i) { table.Update(i << 16, [&](size_t& v) { v = i; }); }
+    ASSERT_LE(table.CountLevels(), 2);
+    for (size_t i = 0; i < 1024; ++i) {
+        auto v = size_t{0};
+        table.Visit(i << 16, [&](auto _v) { v = _v; });
+        ASSERT_EQ(v, i);
+    }
+}
+
+TEST(SwitchTable, BothBackends) {
+    for (auto bucket: {false, true}) {
+        auto table = spectrum::SwitchTable<size_t, size_t, std::hash<size_t>>(bucket, 7, 100);
+        for (size_t k = 0; k < 100; ++k) { table.Update(k, [&](size_t& v) { v = k + 1; }); }
+        for (size_t k = 0; k < 200; ++k) {
+            auto v = size_t{0};
+            table.Visit(k, [&](auto _v) { v = _v; });
+            ASSERT_EQ(v, k < 100 ? k + 1 : 0);
+        }
+    }
+}
+
+TEST(BucketTable, ConcurrentPut) {
+    // a small first level forces keys to spill over several chained levels
+    auto table   = spectrum::BucketTable<std::tuple<evmc::address, evmc::bytes32>, size_t, KeyHasher>(16);
+    auto threads = std::vector<std::thread>();
+    for (size_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() { for (size_t i = 0; i < 10000; ++i) {
+            table.Update({evmc::address{0x1}, evmc::bytes32{i % 1000}}, [](size_t& v) { v += 1; });
+        }});
+    }
+    for (auto& t: threads) { t.join(); }
+    for (size_t i = 0; i < 1000; ++i) {
+        auto v = size_t{0};
+        table.Visit({evmc::address{0x1}, evmc::bytes32{i}}, [&](auto _v) { v = _v; });
+        ASSERT_EQ(v, 80);
+    }
+}
+
 }
@@ -0,0 +1,235 @@
+#pragma once
+#include <unordered_set>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <memory>
+#include <bit>
+
+namespace spectrum {
+
+/// @brief a set of transactions reading one version
+/// @tparam T the transaction type, which must expose a dense `id` field
+/// @tparam N the number of readers stored inline
+/// @tparam W the width of the spilled window, readers are placed by id % W
+template<typename T, size_t N = 4, size_t W = 64>
+class ReaderSet {
+
+    static_assert(W <= 64, "window occupancy is tracked by a 64 bit mask");
+
+    // in-flight ids are dense, so spilled readers mostly land on distinct window slots
+    struct Spill {
+        uint64_t                mask{0};
+        T*                      window[W]{};
+        // readers whose window slot is already taken
+        std::unordered_set<T*>  overflow;
+    };
+
+    private:
+    T*                      slots[N];
+    size_t                  count{0};
+    std::unique_ptr<Spill>  spill;
+
+    public:
+    class iterator;
+    ReaderSet() = default;
+    ReaderSet(ReaderSet&& other);
+    ReaderSet& operator=(ReaderSet&& other);
+    ReaderSet(const ReaderSet&) = delete;
+    ReaderSet& operator=(const ReaderSet&) = delete;
+    bool    insert(T* tx);
+    size_t  erase(T* tx);
+    bool    contains(T* tx) const;
+    size_t  size() const;
+    bool    empty() const { return size() == 0; }
+    void    clear();
+    template<typename Pred>
+    size_t  EraseIf(Pred&& pred);
+    iterator begin() const;
+    iterator end() const;
+
+};
+
+/// @brief iterate inline readers, then the window, then the overflow set
+template<typename T, size_t N, size_t W>
+class ReaderSet<T, N, W>::iterator {
+
+    static constexpr size_t at_overflow = N + W;
+    static constexpr size_t at_end      = N + W + 1;
+
+    private:
+    const ReaderSet*    set;
+    size_t              pos;
+    typename std::unordered_set<T*>::const_iterator it{};
+    friend class ReaderSet;
+    iterator(const ReaderSet* set, size_t pos): set{set}, pos{pos} { Settle(); }
+    void Settle();
+
+    public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = T*;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = T* const*;
+    using reference         = T* const&;
+    iterator() = default;
+    reference operator*() const;
+    iterator& operator++();
+    iterator  operator++(int) { auto tmp = *this; ++*this; return tmp; }
+    bool operator==(const iterator& other) const {
+        return pos == other.pos && (pos != at_overflow || it == other.it);
+    }
+
+};
+
+template<typename T, size_t N, size_t W>
+ReaderSet<T, N, W>::ReaderSet(ReaderSet&& other):
+    count{std::exchange(other.count, 0)},
+    spill{std::move(other.spill)}
+{
+    std::copy(other.slots, other.slots + count, slots);
+}
+
+template<typename T, size_t N, size_t W>
+ReaderSet<T, N, W>& ReaderSet<T, N, W>::operator=(ReaderSet&& other) {
+    count = std::exchange(other.count, 0);
+    spill = std::move(other.spill);
+    std::copy(other.slots, other.slots + count, slots);
+    return *this;
+}
+
+/// @brief add a reader
+/// @param tx the reading transaction
+/// @return true if tx was not in this set before
+template<typename T, size_t N, size_t W>
+bool ReaderSet<T, N, W>::insert(T* tx) {
+    if (contains(tx)) { return false; }
+    if (count != N) {
+        slots[count++] = tx;
+        return true;
+    }
+    if (!spill) { spill = std::make_unique<Spill>(); }
+    auto i = tx->id % W;
+    if (spill->mask & (uint64_t(1) << i)) {
+        spill->overflow.insert(tx);
+        return true;
+    }
+    spill->window[i] = tx;
+    spill->mask |= uint64_t(1) << i;
+    return true;
+}
+
+/// @brief remove a reader
+/// @param tx the reading transaction
+/// @return the number of removed readers, either 0 or 1
+template<typename T, size_t N, size_t W>
+size_t ReaderSet<T, N, W>::erase(T* tx) {
+    for (size_t i = 0; i != count; ++i) {
+        if (slots[i] != tx) { continue; }
+        slots[i] = slots[--count];
+        return 1;
+    }
+    if (!spill) { return 0; }
+    auto i = tx->id % W;
+    if ((spill->mask & (uint64_t(1) << i)) && spill->window[i] == tx) {
+        spill->mask &= ~(uint64_t(1) << i);
+        return 1;
+    }
+    return spill->overflow.erase(tx);
+}
+
+/// @brief check if a transaction reads this version
+/// @param tx the transaction
+/// @return true if tx is in this set
+template<typename T, size_t N, size_t W>
+bool ReaderSet<T, N, W>::contains(T* tx) const {
+    if (std::find(slots, slots + count, tx) != slots + count) { return true; }
+    if (!spill) { return false; }
+    auto i = tx->id % W;
+    if ((spill->mask & (uint64_t(1) << i)) && spill->window[i] == tx) { return true; }
+    return !spill->overflow.empty() && spill->overflow.contains(tx);
+}
+
+/// @brief count readers
+/// @return the number of readers
+template<typename T, size_t N, size_t W>
+size_t ReaderSet<T, N, W>::size() const {
+    if (!spill) { return count; }
+    return count + std::popcount(spill->mask) + spill->overflow.size();
+}
+
+/// @brief remove all readers, keeping the spilled window for reuse
+template<typename T, size_t N, size_t W>
+void ReaderSet<T, N, W>::clear() {
+    count = 0;
+    if (!spill) { return; }
+    spill->mask = 0;
+    spill->overflow.clear();
+}
+
+/// @brief remove readers satisfying a predicate
+/// @param pred called once on each reader, returns true if the reader should be removed
+/// @return the number of removed readers
+template<typename T, size_t N, size_t W>
+template<typename Pred>
+size_t ReaderSet<T, N, W>::EraseIf(Pred&& pred) {
+    auto erased = size_t{0};
+    for (size_t i = 0; i != count;) {
+        if (!pred(slots[i])) { ++i; continue; }
+        slots[i] = slots[--count];
+        ++erased;
+    }
+    if (!spill) { return erased; }
+    for (auto mask = spill->mask; mask; mask &= mask - 1) {
+        auto i = std::countr_zero(mask);
+        if (!pred(spill->window[i])) { continue; }
+        spill->mask &= ~(uint64_t(1) << i);
+        ++erased;
+    }
+    return erased + std::erase_if(spill->overflow, pred);
+}
+
+template<typename T, size_t N, size_t W>
+typename ReaderSet<T, N, W>::iterator ReaderSet<T, N, W>::begin() const {
+    return iterator(this, 0);
+}
+
+template<typename T, size_t N, size_t W>
+typename ReaderSet<T, N, W>::iterator ReaderSet<T, N, W>::end() const {
+    return iterator(this, iterator::at_end);
+}
+
+/// @brief move forward until the iterator points at a reader or the end
+template<typename T, size_t N, size_t W>
+void ReaderSet<T, N, W>::iterator::Settle() {
+    if (pos < N && pos < set->count) { return; }
+    // past the inline slots, which ++ reaches from slot N-1 with or without a spill
+    if (!set->spill) { pos = at_end; return; }
+    if (pos < N) { pos = N; }
+    if (pos < at_overflow) {
+        auto rest = set->spill->mask >> (pos - N);
+        if (rest) { pos += std::countr_zero(rest); return; }
+        pos = at_overflow;
+        it  = set->spill->overflow.begin();
+    }
+    if (pos == at_overflow && it == set->spill->overflow.end()) { pos = at_end; }
+}
+
+template<typename T, size_t N, size_t W>
+typename ReaderSet<T, N, W>::iterator::reference ReaderSet<T, N, W>::iterator::operator*() const {
+    if (pos < N) { return set->slots[pos]; }
+    if (pos < at_overflow) { return set->spill->window[pos - N]; }
+    return *it;
+}
+
+template<typename T, size_t N, size_t W>
+typename ReaderSet<T, N, W>::iterator& ReaderSet<T, N, W>::iterator::operator++() {
+    if (pos == at_overflow) { ++it; }
+    else if (pos + 1 == at_overflow) { pos = at_overflow; it = set->spill->overflow.begin(); }
+    else { ++pos; }
+    Settle();
+    return *this;
+}
+
+} // namespace spectrum
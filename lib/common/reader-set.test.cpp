@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <spectrum/common/reader-set.hpp>
+#include <algorithm>
+#include <vector>
+#include <set>
+
+namespace {
+
+using namespace spectrum;
+
+struct Tx {
+    size_t id;
+};
+
+std::set<Tx*> Collect(const ReaderSet<Tx>& readers) {
+    auto collected = std::set<Tx*>();
+    for (auto tx: readers) { collected.insert(tx); }
+    return collected;
+}
+
+TEST(ReaderSet, InsertAndErase) {
+    // 200 transactions exercise the inline slots, the window and collisions in the window
+    auto txs = std::vector<Tx>(200);
+    for (size_t i = 0; i < txs.size(); ++i) { txs[i].id = i + 1; }
+    auto readers = ReaderSet<Tx>();
+    auto expect  = std::set<Tx*>();
+    for (auto& tx: txs) {
+        ASSERT_TRUE(readers.insert(&tx));
+        ASSERT_FALSE(readers.insert(&tx));
+        expect.insert(&tx);
+    }
+    ASSERT_EQ(readers.size(), txs.size());
+    ASSERT_EQ(Collect(readers), expect);
+    for (size_t i = 0; i < txs.size(); i += 3) {
+        ASSERT_EQ(readers.erase(&txs[i]), 1);
+        ASSERT_EQ(readers.erase(&txs[i]), 0);
+        expect.erase(&txs[i]);
+    }
+    ASSERT_EQ(readers.size(), expect.size());
+    ASSERT_EQ(Collect(readers), expect);
+    for (auto& tx: txs) { ASSERT_EQ(readers.contains(&tx), expect.contains(&tx)); }
+    readers.clear();
+    ASSERT_TRUE(readers.empty());
+    ASSERT_TRUE(readers.begin() == readers.end());
+}
+
+TEST(ReaderSet, FullInlineSlots) {
+    // exactly as many readers as inline slots, so iteration runs off the slots without a spill
+    auto txs = std::vector<Tx>(4);
+    for (size_t i = 0; i < txs.size(); ++i) { txs[i].id = i + 1; }
+    auto readers = ReaderSet<Tx, 4>();
+    auto expect  = std::set<Tx*>();
+    for (auto& tx: txs) { readers.insert(&tx); expect.insert(&tx); }
+    auto collected = std::set<Tx*>();
+    for (auto tx: readers) { collected.insert(tx); }
+    ASSERT_EQ(collected, expect);
+    ASSERT_EQ(readers.erase(&txs[0]), 1);
+    ASSERT_EQ(readers.EraseIf([](Tx* tx) { return tx->id == 4; }), 1);
+    collected.clear();
+    for (auto tx: readers) { collected.insert(tx); }
+    ASSERT_EQ(collected, (std::set<Tx*>{&txs[1], &txs[2]}));
+}
+
+TEST(ReaderSet, EraseIf) {
+    auto txs = std::vector<Tx>(100);
+    for (size_t i = 0; i < txs.size(); ++i) { txs[i].id = i; }
+    auto readers = ReaderSet<Tx>();
+    for (auto& tx: txs) { readers.insert(&tx); }
+    auto erased = readers.EraseIf([](Tx* tx) { return tx->id >= 50; });
+    ASSERT_EQ(erased, 50);
+    ASSERT_EQ(readers.size(), 50);
+    for (auto tx: readers) { ASSERT_LT(tx->id, 50); }
+    // moving hands over both inline and spilled readers
+    auto moved = std::move(readers);
+    ASSERT_EQ(moved.size(), 50);
+    ASSERT_TRUE(readers.empty());
+}
+
+}
@@ -8,6 +8,7 @@
 #include <glog/logging.h>
 #include <cstdlib>
 #include <ethash/keccak.hpp>
+#include <jemalloc/jemalloc.h>
 
 namespace spectrum {
 
@@ -49,6 +50,76 @@ void Statistics::JournalOperations(size_t count) {
     count_operation.fetch_add(count, std::memory_order_relaxed);
 }
 
+void Statistics::JournalLocks(size_t count) {
+    count_lock.fetch_add(count, std::memory_order_relaxed);
+    journaled_locks.store(true, std::memory_order_relaxed);
+}
+
+void Statistics::JournalAccesses(size_t local, size_t remote) {
+    count_local_access.fetch_add(local, std::memory_order_relaxed);
+    count_remote_access.fetch_add(remote, std::memory_order_relaxed);
+    journaled_accesses.store(true, std::memory_order_relaxed);
+}
+
+void Statistics::JournalExecutorTime(std::chrono::nanoseconds wait, std::chrono::nanoseconds total) {
+    using namespace std::chrono;
+    count_wait_us.fetch_add(duration_cast<microseconds>(wait).count(), std::memory_order_relaxed);
+    count_busy_us.fetch_add(duration_cast<microseconds>(total - wait).count(), std::memory_order_relaxed);
+    journaled_executor_time.store(true, std::memory_order_relaxed);
+}
+
+void Statistics::JournalHotKey(std::string key, size_t accesses, size_t aborts) {
+    auto guard = Guard{hot_keys_mu};
+    hot_keys.push_back({std::move(key), accesses, aborts});
+}
+
+void Statistics::JournalAllocations(size_t count) {
+    count_allocation.fetch_add(count, std::memory_order_relaxed);
+}
+
+void Statistics::JournalAnalysis(size_t nanoseconds) {
+    count_analysis_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+size_t Statistics::CountCommits() {
+    return count_commit.load(std::memory_order_relaxed);
+}
+
+size_t Statistics::CountExecutions() {
+    return count_execution.load(std::memory_order_relaxed);
+}
+
+/// @brief the number of allocation requests jemalloc served so far, over all threads
+/// @return the count, or 0 if jemalloc keeps no statistics
+size_t CountAllocations() {
+    // statistics are only refreshed when the epoch advances
+    auto epoch = uint64_t{1};
+    auto epoch_size = sizeof(epoch);
+    mallctl("epoch", &epoch, &epoch_size, &epoch, epoch_size);
+    auto count = size_t{0};
+    for (auto kind: {"small", "large"}) {
+        auto name  = fmt::format("stats.arenas.{}.{}.nrequests", MALLCTL_ARENAS_ALL, kind);
+        auto value = uint64_t{0};
+        auto size  = sizeof(value);
+        if (mallctl(name.c_str(), &value, &size, nullptr, 0) != 0) { return 0; }
+        count += value;
+    }
+    return count;
+}
+
+std::string Statistics::PrintHotKeys() {
+    auto guard = Guard{hot_keys_mu};
+    std::sort(hot_keys.begin(), hot_keys.end(), [](auto& a, auto& b) {
+        return std::get<2>(a) > std::get<2>(b);
+    });
+    auto result = std::string();
+    for (size_t i = 0; i < hot_keys.size() && i < HOT_KEYS; ++i) {
+        auto& [key, accesses, aborts] = hot_keys[i];
+        result += fmt::format("hot key       {} accesses {} aborts {}\n", key, accesses, aborts);
+    }
+    return result;
+}
+
 std::string Statistics::Print() {
     #define PERCENTILE(X) sample_latency_[X * sample_latency_.size() / 100]
     auto sample_latency_ = std::vector<size_t>();
@@ -65,6 +136,11 @@ std::string Statistics::Print() {
         "memory             {}\n"
         "execution          {}\n"
         "operation          {}\n"
+        "{}"
+        "{}"
+        "{}"
+        "allocation         {}\n"
+        "analysis           {}ns\n"
         "25us               {}\n"
         "50us               {}\n"
         "100us              {}\n"
@@ -78,6 +154,19 @@ std::string Statistics::Print() {
         count_memory.load(),
         count_execution.load(),
         count_operation.load(),
+        journaled_locks.load() ? fmt::format("lock               {}\n", count_lock.load()) : std::string(),
+        journaled_accesses.load() ? fmt::format(
+            "local access       {}\n"
+            "remote access      {}\n",
+            count_local_access.load(), count_remote_access.load()
+        ) : std::string(),
+        journaled_executor_time.load() ? fmt::format(
+            "wait time          {}us\n"
+            "busy time          {}us\n",
+            count_wait_us.load(), count_busy_us.load()
+        ) : std::string(),
+        count_allocation.load(),
+        count_analysis_ns.load(),
         count_latency_25us.load(),
         count_latency_50us.load(),
         count_latency_100us.load(),
@@ -86,7 +175,7 @@ std::string Statistics::Print() {
         PERCENTILE(75),
         PERCENTILE(95),
         PERCENTILE(99)
-    ));
+    )) + PrintHotKeys();
     #undef PERCENTILE
 }
 
@@ -108,6 +197,11 @@ std::string Statistics::PrintWithDuration(std::chrono::milliseconds duration) {
         "memory        {:.4f} bytes/s\n"
         "execution     {:.4f} tx/s\n"
         "operation     {:.4f} op/s\n"
+        "{}"
+        "{}"
+        "{}"
+        "allocation    {:.4f} alloc/tx\n"
+        "analysis      {:.4f} ns/tx\n"
         "25us          {:.4f} tx/s\n"
         "50us          {:.4f} tx/s\n"
         "100us         {:.4f} tx/s\n"
@@ -122,6 +216,21 @@ std::string Statistics::PrintWithDuration(std::chrono::milliseconds duration) {
         AVG(count_memory),
         AVG(count_execution),
         AVG(count_operation),
+        journaled_locks.load() ? fmt::format(
+            "lock          {:.4f} lock/tx\n",
+            (double)(count_lock.load()) / (double)(std::max(count_commit.load(), size_t{1}))
+        ) : std::string(),
+        journaled_accesses.load() ? fmt::format(
+            "local access  {:.4f} op/s\n"
+            "remote access {:.4f} op/s\n",
+            AVG(count_local_access), AVG(count_remote_access)
+        ) : std::string(),
+        journaled_executor_time.load() ? fmt::format(
+            "wait          {:.2f}% of executor time\n",
+            100.0 * (double)(count_wait_us.load()) / (double)(std::max(count_wait_us.load() + count_busy_us.load(), size_t{1}))
+        ) : std::string(),
+        (double)(count_allocation.load()) / (double)(std::max(count_commit.load(), size_t{1})),
+        (double)(count_analysis_ns.load()) / (double)(std::max(count_commit.load(), size_t{1})),
         AVG(count_latency_25us),
         AVG(count_latency_50us),
         AVG(count_latency_100us),
@@ -130,7 +239,7 @@ std::string Statistics::PrintWithDuration(std::chrono::milliseconds duration) {
         PERCENTILE(75),
         PERCENTILE(95),
         PERCENTILE(99)
-    ));
+    )) + PrintHotKeys();
     #undef AVG
     #undef PERCENTILE
 }
@@ -5,6 +5,9 @@
 #include <set>
 #include <iterator>
 #include <array>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace spectrum {
 
@@ -17,11 +20,26 @@ class Statistics {
     std::atomic<size_t> count_memory{0};
     std::atomic<size_t> count_execution{0};
     std::atomic<size_t> count_operation{0};
+    std::atomic<size_t> count_lock{0};
+    // protocols without partition locks never journal them, and print no lock count
+    std::atomic<bool>   journaled_locks{false};
+    std::atomic<size_t> count_local_access{0};
+    std::atomic<size_t> count_remote_access{0};
+    std::atomic<bool>   journaled_accesses{false};
+    std::atomic<size_t> count_wait_us{0};
+    std::atomic<size_t> count_busy_us{0};
+    std::atomic<bool>   journaled_executor_time{false};
+    std::atomic<size_t> count_allocation{0};
+    std::atomic<size_t> count_analysis_ns{0};
     std::atomic<size_t> count_latency_25us{0};
     std::atomic<size_t> count_latency_50us{0};
     std::atomic<size_t> count_latency_100us{0};
     std::atomic<size_t> count_latency_100us_above{0};
     std::array<std::atomic<size_t>, SAMPLE> sample_latency;
+    static const int HOT_KEYS = 10;
+    SpinLock    hot_keys_mu;
+    std::vector<std::tuple<std::string, size_t, size_t>> hot_keys;
+    std::string PrintHotKeys();
 
     public:
     Statistics() = default;
@@ -30,9 +48,19 @@ class Statistics {
     void JournalCommit(size_t latency);
     void JournalExecute();
     void JournalOperations(size_t count);
+    void JournalLocks(size_t count);
+    void JournalAccesses(size_t local, size_t remote);
+    void JournalExecutorTime(std::chrono::nanoseconds wait, std::chrono::nanoseconds total);
+    void JournalHotKey(std::string key, size_t accesses, size_t aborts);
+    void JournalAllocations(size_t count);
+    void JournalAnalysis(size_t nanoseconds);
+    size_t CountCommits();
+    size_t CountExecutions();
     std::string Print();
     std::string PrintWithDuration(std::chrono::milliseconds duration);
 
 };
 
+size_t CountAllocations();
+
 } // namespace spectrum
@@ -21,4 +21,18 @@ TEST(Statistics, BenchJournal) {
     std::cerr << statistics.PrintWithDuration(200ms) << std::endl;
 }
 
+TEST(Statistics, PrintOnlyIfJournaled) {
+    auto statistics = spectrum::Statistics();
+    statistics.JournalCommit(10);
+    ASSERT_EQ(statistics.PrintWithDuration(1000ms).find("lock/tx"), std::string::npos);
+    ASSERT_EQ(statistics.PrintWithDuration(1000ms).find("local access"), std::string::npos);
+    ASSERT_EQ(statistics.PrintWithDuration(1000ms).find("of executor time"), std::string::npos);
+    statistics.JournalLocks(3);
+    statistics.JournalAccesses(2, 1);
+    statistics.JournalExecutorTime(1ms, 4ms);
+    ASSERT_NE(statistics.PrintWithDuration(1000ms).find("lock          3.0000 lock/tx"), std::string::npos);
+    ASSERT_NE(statistics.PrintWithDuration(1000ms).find("remote access 1.0000 op/s"), std::string::npos);
+    ASSERT_NE(statistics.PrintWithDuration(1000ms).find("wait          25.00% of executor time"), std::string::npos);
+}
+
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <spectrum/common/thread-util.hpp>
+#include <spectrum/common/topology.hpp>
 #include <thread>
 #include <pthread.h>
 #include <string>
@@ -8,7 +9,9 @@
 
 void PinRoundRobin(std::thread& thread, unsigned rotate_id) {
     #include <pthread.h>
-    auto core_id    = rotate_id % std::thread::hardware_concurrency();
+    auto core_id    = FLAGS_numa ?
+        spectrum::Topology::Get().CpuOfThread(rotate_id) :
+        rotate_id % std::thread::hardware_concurrency();
     cpu_set_t   cpu_set;
     CPU_ZERO(&cpu_set);
     CPU_SET (core_id, &cpu_set);
@@ -22,11 +25,14 @@ void PinRoundRobin(std::thread& thread, unsigned rotate_id) {
            << " to core "          << core_id;       
         throw std::runtime_error(ss.str());
     }
+    spectrum::Topology::Pinned();
 }
 
 void PinRoundRobin(std::jthread& thread, unsigned rotate_id) {
     #include <pthread.h>
-    auto core_id    = rotate_id % std::thread::hardware_concurrency();
+    auto core_id    = FLAGS_numa ?
+        spectrum::Topology::Get().CpuOfThread(rotate_id) :
+        rotate_id % std::thread::hardware_concurrency();
     cpu_set_t   cpu_set;
     CPU_ZERO(&cpu_set);
     CPU_SET (core_id, &cpu_set);
@@ -40,4 +46,5 @@ void PinRoundRobin(std::jthread& thread, unsigned rotate_id) {
            << " to core "          << core_id;       
         throw std::runtime_error(ss.str());
     }
+    spectrum::Topology::Pinned();
 }
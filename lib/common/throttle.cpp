@@ -0,0 +1,93 @@
+#include <spectrum/common/throttle.hpp>
+#include <glog/logging.h>
+#include <fmt/core.h>
+#include <algorithm>
+
+DEFINE_uint64(throttle_ms, 0, "sampling interval of the executor count controller in spectrum and sparkle, 0 keeps every executor running");
+
+namespace spectrum {
+
+/// @brief an executor count controller, which admits every executor until started
+/// @param statistics the statistics to sample commits and executions from
+/// @param signal the signal parked executors wait on, notified on every adjustment
+/// @param max_executors the configured number of executors, which is never exceeded
+/// @param interval the sampling interval
+Throttle::Throttle(Statistics& statistics, Signal& signal, size_t max_executors, std::chrono::milliseconds interval):
+    statistics{statistics},
+    signal{signal},
+    max_executors{max_executors},
+    step{std::max(max_executors / 8, size_t{1})},
+    interval{interval},
+    active{max_executors}
+{}
+
+Throttle::~Throttle() {
+    Stop();
+}
+
+/// @brief start sampling, does nothing with a zero interval
+void Throttle::Start() {
+    if (interval.count() == 0) { return; }
+    LOG(INFO) << fmt::format("Throttle(max_executors={}, step={}, interval={}ms)", max_executors, step, interval.count());
+    stop_flag.store(false);
+    thread = std::thread([this]{ Run(); });
+}
+
+/// @brief stop sampling and admit every executor again
+void Throttle::Stop() {
+    stop_flag.store(true);
+    if (!thread.joinable()) { return; }
+    thread.join();
+    LOG(INFO) << fmt::format("Throttle(active={})", active.load());
+    active.store(max_executors);
+    signal.Notify();
+}
+
+/// @brief check if an executor may pick up new work, executors only ask while they hold no transaction
+/// @param executor_id the index of the executor, lower indexes are admitted first
+bool Throttle::Admit(size_t executor_id) const {
+    return executor_id < active.load(std::memory_order_relaxed);
+}
+
+/// @brief the number of admitted executors
+size_t Throttle::Active() const {
+    return active.load();
+}
+
+/// @brief move the executor count by one step, given what the last interval achieved
+/// @param commits the number of commits in the last interval
+/// @param executions the number of executions, including re-executions, in the last interval
+void Throttle::Adjust(size_t commits, size_t executions) {
+    auto current = (double) commits;
+    auto aborts  = executions > commits ? (double) (executions - commits) / (double) executions : 0.0;
+    // keep climbing while it pays off, turn around when it hurts.
+    // on a plateau, contention decides: many re-executions ask for fewer executors.
+    if (current < last_commits * (1 - tolerance)) {
+        direction = -direction;
+    }
+    else if (current <= last_commits * (1 + tolerance)) {
+        direction = aborts > abort_threshold ? -1 : 1;
+    }
+    last_commits = current;
+    auto _active = (long) active.load();
+    _active = std::clamp(_active + direction * (long) step, 1L, (long) max_executors);
+    DLOG(INFO) << fmt::format("throttle commits={} aborts={:.2f} active={}", commits, aborts, _active);
+    active.store(_active);
+}
+
+/// @brief sample statistics every interval and adjust, waking up parked executors
+void Throttle::Run() {
+    auto commits    = statistics.CountCommits();
+    auto executions = statistics.CountExecutions();
+    while (!stop_flag.load()) {
+        std::this_thread::sleep_for(interval);
+        auto _commits    = statistics.CountCommits();
+        auto _executions = statistics.CountExecutions();
+        Adjust(_commits - commits, _executions - executions);
+        commits    = _commits;
+        executions = _executions;
+        signal.Notify();
+    }
+}
+
+} // namespace spectrum
@@ -0,0 +1,45 @@
+#pragma once
+#include <spectrum/common/statistics.hpp>
+#include <spectrum/common/wait-util.hpp>
+#include <gflags/gflags.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+DECLARE_uint64(throttle_ms);
+
+namespace spectrum {
+
+/// @brief a hill-climbing controller of how many executors run, driven by the commit rate and the abort rate it samples
+class Throttle {
+
+    // abort rate above which a flat commit rate is taken as a sign of too many executors
+    static constexpr double abort_threshold = 0.5;
+    // relative commit rate change below which two samples count as equal
+    static constexpr double tolerance = 0.05;
+
+    private:
+    Statistics&             statistics;
+    Signal&                 signal;
+    size_t                  max_executors;
+    size_t                  step;
+    std::chrono::milliseconds   interval;
+    std::atomic<size_t>     active;
+    std::atomic<bool>       stop_flag{false};
+    std::thread             thread{};
+    long                    direction{-1};
+    double                  last_commits{0};
+    void Run();
+
+    public:
+    Throttle(Statistics& statistics, Signal& signal, size_t max_executors, std::chrono::milliseconds interval);
+    ~Throttle();
+    void    Start();
+    void    Stop();
+    bool    Admit(size_t executor_id) const;
+    size_t  Active() const;
+    void    Adjust(size_t commits, size_t executions);
+
+};
+
+} // namespace spectrum
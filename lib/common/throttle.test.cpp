@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <spectrum/common/throttle.hpp>
+#include <cstdlib>
+
+namespace {
+
+using namespace spectrum;
+using namespace std::chrono_literals;
+
+TEST(Throttle, AdmitAllUntilStarted) {
+    auto statistics = Statistics();
+    auto signal     = Signal();
+    auto throttle   = Throttle(statistics, signal, 8, 0ms);
+    throttle.Start();
+    for (size_t i = 0; i < 8; ++i) { ASSERT_TRUE(throttle.Admit(i)); }
+    ASSERT_FALSE(throttle.Admit(8));
+    throttle.Stop();
+}
+
+TEST(Throttle, ClimbToPeak) {
+    auto statistics = Statistics();
+    auto signal     = Signal();
+    auto throttle   = Throttle(statistics, signal, 36, 0ms);
+    // commits peak at 12 executors, and every extra executor mostly re-executes
+    auto commits = [](size_t n) { return 1200 - 40 * (size_t) std::abs((long) n - 12); };
+    for (size_t round = 0; round < 64; ++round) {
+        auto n = throttle.Active();
+        throttle.Adjust(commits(n), commits(n) * (n > 12 ? 4 : 1));
+    }
+    // it keeps probing around the peak, one step at a time
+    for (size_t round = 0; round < 16; ++round) {
+        auto n = throttle.Active();
+        ASSERT_GE(n, 8);
+        ASSERT_LE(n, 16);
+        throttle.Adjust(commits(n), commits(n) * (n > 12 ? 4 : 1));
+    }
+}
+
+TEST(Throttle, StayAtMaxWithoutContention) {
+    auto statistics = Statistics();
+    auto signal     = Signal();
+    auto throttle   = Throttle(statistics, signal, 36, 0ms);
+    for (size_t round = 0; round < 64; ++round) {
+        auto n = throttle.Active();
+        throttle.Adjust(100 * n, 100 * n);
+    }
+    ASSERT_GE(throttle.Active(), 36 - 4);
+}
+
+}
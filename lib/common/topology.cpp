@@ -0,0 +1,164 @@
+#include <spectrum/common/topology.hpp>
+#include <glog/logging.h>
+#include <fmt/core.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+
+DEFINE_bool(numa, false, "pin executors node by node and place table partitions on their home numa node");
+
+namespace spectrum {
+
+/// @brief parse a cpu list like "0-15,32-47"
+/// @param list the cpu list in sysfs format
+/// @return the listed cpus
+static std::vector<unsigned> ParseCpuList(const std::string& list) {
+    auto cpus = std::vector<unsigned>();
+    auto ss   = std::stringstream(list);
+    auto tok  = std::string();
+    while (std::getline(ss, tok, ',')) {
+        if (tok.empty() || tok == "\n") { continue; }
+        auto dash = tok.find('-');
+        auto lo = (unsigned) std::stoul(tok.substr(0, dash));
+        auto hi = dash == std::string::npos ? lo : (unsigned) std::stoul(tok.substr(dash + 1));
+        for (auto cpu = lo; cpu <= hi; ++cpu) { cpus.push_back(cpu); }
+    }
+    return cpus;
+}
+
+/// @brief read the nodes and their cpus, falling back to a single node holding every cpu
+Topology::Topology() {
+    namespace fs = std::filesystem;
+    auto root = fs::path("/sys/devices/system/node");
+    auto error = std::error_code();
+    // node ids can have holes, e.g. after a node is offlined, so list them instead of counting up
+    for (auto& entry: fs::directory_iterator(root, error)) {
+        auto name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0) { continue; }
+        if (!std::all_of(name.begin() + 4, name.end(), [](char c) { return '0' <= c && c <= '9'; })) { continue; }
+        node_ids.push_back(std::stoul(name.substr(4)));
+    }
+    std::sort(node_ids.begin(), node_ids.end());
+    for (auto id: node_ids) {
+        auto file = std::ifstream(root / fmt::format("node{}", id) / "cpulist");
+        auto list = std::string();
+        std::getline(file, list);
+        node_cpus.push_back(ParseCpuList(list));
+    }
+    if (node_cpus.empty()) {
+        node_ids.assign(1, 0);
+        node_cpus.emplace_back();
+        for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+            node_cpus[0].push_back(cpu);
+        }
+    }
+    for (size_t node = 0; node < node_cpus.size(); ++node) {
+        for (auto cpu: node_cpus[node]) {
+            if (cpu >= cpu_node.size()) { cpu_node.resize(cpu + 1, 0); }
+            cpu_node[cpu] = node;
+        }
+    }
+    LOG(INFO) << fmt::format("Topology(nodes={}, cpus={})", node_cpus.size(), cpu_node.size());
+}
+
+/// @brief the topology of this machine
+const Topology& Topology::Get() {
+    static auto topology = Topology();
+    return topology;
+}
+
+/// @brief the number of numa nodes
+size_t Topology::NumNodes() const {
+    return node_cpus.size();
+}
+
+/// @brief the id the kernel gives a node
+/// @param node the index of the node, below NumNodes()
+size_t Topology::NodeId(size_t node) const {
+    return node_ids[node];
+}
+
+/// @brief the node a cpu belongs to
+/// @param cpu the cpu number
+size_t Topology::NodeOfCpu(unsigned cpu) const {
+    return cpu < cpu_node.size() ? cpu_node[cpu] : 0;
+}
+
+/// @brief the cpu for the i-th pinned thread, filling a node before spilling to the next one
+/// @param rotate_id the index of the thread
+unsigned Topology::CpuOfThread(size_t rotate_id) const {
+    auto total = size_t{0};
+    for (auto& cpus: node_cpus) { total += cpus.size(); }
+    auto i = rotate_id % std::max(total, size_t{1});
+    for (auto& cpus: node_cpus) {
+        if (i < cpus.size()) { return cpus[i]; }
+        i -= cpus.size();
+    }
+    return 0;
+}
+
+// bumped after a thread is pinned, so that threads look up their node again
+static std::atomic<size_t> pin_epoch{0};
+
+/// @brief the node the calling thread is running on, cached until some thread is pinned again
+size_t Topology::CurrentNode() {
+    thread_local auto epoch = ~size_t{0};
+    thread_local auto node  = size_t{0};
+    auto now = pin_epoch.load(std::memory_order_acquire);
+    if (epoch != now) {
+        auto cpu = sched_getcpu();
+        epoch = now;
+        node  = cpu < 0 ? 0 : Get().NodeOfCpu(cpu);
+    }
+    return node;
+}
+
+/// @brief tell threads that one of them moved, call after changing the affinity of a thread
+void Topology::Pinned() {
+    pin_epoch.fetch_add(1, std::memory_order_release);
+}
+
+/// @brief a memory resource placing pages on a node
+/// @param node the kernel id of the home node
+NodeResource::NodeResource(size_t node):
+    node{node}
+{}
+
+/// @brief map fresh pages and prefer the home node for them
+void* NodeResource::do_allocate(size_t bytes, size_t alignment) {
+    CHECK(alignment <= (size_t) sysconf(_SC_PAGESIZE)) << "page alignment is the most we provide";
+    auto p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) { throw std::bad_alloc(); }
+    // pages are not backed until first touched, the policy decides where that touch lands
+    constexpr auto bits = sizeof(unsigned long) * 8;
+    auto mask = std::vector<unsigned long>(node / bits + 1, 0);
+    mask[node / bits] = 1UL << (node % bits);
+    // the kernel reads one bit less than maxnode
+    if (syscall(SYS_mbind, p, bytes, MPOL_PREFERRED, mask.data(), mask.size() * bits + 1, 0) != 0) {
+        DLOG(WARNING) << "cannot bind pages to node " << node;
+    }
+    return p;
+}
+
+/// @brief unmap pages
+void NodeResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    munmap(p, bytes);
+}
+
+/// @brief node resources only free their own pages
+bool NodeResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace spectrum
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <memory_resource>
+#include <gflags/gflags.h>
+
+DECLARE_bool(numa);
+
+namespace spectrum {
+
+/// @brief the numa layout of this machine, read once from /sys/devices/system/node
+class Topology {
+
+    private:
+    std::vector<size_t>                 node_ids;
+    std::vector<std::vector<unsigned>>  node_cpus;
+    std::vector<size_t>                 cpu_node;
+    Topology();
+
+    public:
+    static const Topology& Get();
+    size_t      NumNodes() const;
+    size_t      NodeId(size_t node) const;
+    size_t      NodeOfCpu(unsigned cpu) const;
+    unsigned    CpuOfThread(size_t rotate_id) const;
+    static size_t   CurrentNode();
+    static void     Pinned();
+
+};
+
+/// @brief an upstream memory resource that places its pages on one numa node
+class NodeResource: public std::pmr::memory_resource {
+
+    private:
+    size_t  node;
+
+    public:
+    NodeResource(size_t node);
+
+    protected:
+    void*   do_allocate(size_t bytes, size_t alignment) override;
+    void    do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool    do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+};
+
+} // namespace spectrum
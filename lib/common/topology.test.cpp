@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <spectrum/common/topology.hpp>
+#include <spectrum/common/lock-util.hpp>
+#include <functional>
+
+namespace {
+
+using namespace spectrum;
+
+TEST(Topology, FillNodeBeforeSpilling) {
+    auto& topology = Topology::Get();
+    ASSERT_GE(topology.NumNodes(), 1);
+    // consecutive threads stay on one node until it runs out of cpus
+    auto last_node = size_t{0};
+    for (size_t i = 0; i < 256; ++i) {
+        auto node = topology.NodeOfCpu(topology.CpuOfThread(i));
+        if (topology.CpuOfThread(i) == topology.CpuOfThread(0) && i != 0) { break; }
+        ASSERT_GE(node, last_node);
+        last_node = node;
+    }
+}
+
+TEST(Topology, NodeIds) {
+    auto& topology = Topology::Get();
+    for (size_t node = 1; node < topology.NumNodes(); ++node) {
+        ASSERT_LT(topology.NodeId(node - 1), topology.NodeId(node));
+    }
+    // node ids past the width of one mask word still get their pages
+    for (auto id: {size_t{0}, topology.NodeId(topology.NumNodes() - 1), size_t{64}, size_t{200}}) {
+        auto resource = NodeResource(id);
+        auto p = (size_t*) resource.allocate(4096, alignof(size_t));
+        p[0] = id;
+        ASSERT_EQ(p[0], id);
+        resource.deallocate(p, 4096, alignof(size_t));
+    }
+}
+
+TEST(Topology, CountAccesses) {
+    FLAGS_numa = true;
+    auto table = Table<size_t, size_t, std::hash<size_t>>(8);
+    FLAGS_numa = false;
+    for (size_t k = 0; k < 100; ++k) { table.Update(k, [&](size_t& v) { v = k; }); }
+    ASSERT_EQ(table.CountLocalAccesses() + table.CountRemoteAccesses(), 100);
+    auto v = size_t{0};
+    table.Visit(42, [&](auto _v) { v = _v; });
+    ASSERT_EQ(v, 42);
+}
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <new>
+
+namespace spectrum {
+
+/// @brief a contiguous list of versions sorted by version number
+/// @tparam Entry the version entry, which must expose a `version` field
+/// @tparam N the number of entries stored inline before spilling into the allocator
+template<typename Entry, size_t N = 2>
+class VersionVector {
+
+    public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    using iterator = Entry*;
+
+    private:
+    allocator_type  alloc;
+    Entry*          buffer;
+    size_t          capacity{N};
+    // live entries are buffer[head, tail), a truncated prefix only moves head forward
+    size_t          head{0};
+    size_t          tail{0};
+    alignas(Entry) std::byte storage[N * sizeof(Entry)];
+
+    bool Inline() const { return (const std::byte*) buffer == storage; }
+    void Relocate(Entry* target);
+    void MakeRoom();
+
+    public:
+    VersionVector(const allocator_type& alloc = {});
+    VersionVector(VersionVector&& other, const allocator_type& alloc = {});
+    VersionVector(const VersionVector&) = delete;
+    VersionVector& operator=(const VersionVector&) = delete;
+    ~VersionVector();
+    iterator begin() { return buffer + head; }
+    iterator end() { return buffer + tail; }
+    size_t   size() const { return tail - head; }
+    bool     empty() const { return tail == head; }
+    Entry&   front() { return buffer[head]; }
+    Entry&   back() { return buffer[tail - 1]; }
+    iterator Find(size_t version);
+    iterator Floor(size_t version);
+    iterator Insert(Entry&& entry);
+    void     Erase(iterator it);
+    void     TruncateBefore(size_t version);
+    void     Reserve(size_t n);
+
+};
+
+template<typename Entry, size_t N>
+VersionVector<Entry, N>::VersionVector(const allocator_type& alloc):
+    alloc{alloc},
+    buffer{reinterpret_cast<Entry*>(storage)}
+{}
+
+template<typename Entry, size_t N>
+VersionVector<Entry, N>::VersionVector(VersionVector&& other, const allocator_type& alloc):
+    alloc{alloc},
+    buffer{reinterpret_cast<Entry*>(storage)}
+{
+    // steal the spilled buffer if it comes from the same arena, otherwise move entries one by one
+    if (!other.Inline() && other.alloc == alloc) {
+        buffer   = std::exchange(other.buffer, reinterpret_cast<Entry*>(other.storage));
+        capacity = std::exchange(other.capacity, N);
+        head     = std::exchange(other.head, 0);
+        tail     = std::exchange(other.tail, 0);
+        return;
+    }
+    Reserve(other.size());
+    for (auto& entry: other) {
+        new (buffer + tail++) Entry(std::move(entry));
+    }
+    std::destroy(other.begin(), other.end());
+    other.head = other.tail = 0;
+}
+
+template<typename Entry, size_t N>
+VersionVector<Entry, N>::~VersionVector() {
+    std::destroy(begin(), end());
+    if (!Inline()) {
+        alloc.deallocate_bytes(buffer, capacity * sizeof(Entry), alignof(Entry));
+    }
+}
+
+/// @brief move live entries to the front of target buffer
+/// @param target the buffer to move into, may be the current buffer
+template<typename Entry, size_t N>
+void VersionVector<Entry, N>::Relocate(Entry* target) {
+    // each source is destroyed right after moving, so overlapping targets are always raw memory
+    for (size_t i = 0; head + i != tail; ++i) {
+        new (target + i) Entry(std::move(buffer[head + i]));
+        buffer[head + i].~Entry();
+    }
+    tail -= head;
+    head  = 0;
+}
+
+/// @brief ensure there is a free slot after tail
+template<typename Entry, size_t N>
+void VersionVector<Entry, N>::MakeRoom() {
+    if (tail != capacity) { return; }
+    // a truncated prefix leaves enough slack, reuse it
+    if (head * 2 >= capacity) { Relocate(buffer); return; }
+    Reserve(capacity * 2);
+}
+
+/// @brief grow the buffer to hold at least n entries
+/// @param n the number of entries
+template<typename Entry, size_t N>
+void VersionVector<Entry, N>::Reserve(size_t n) {
+    if (n <= capacity) { return; }
+    auto target = static_cast<Entry*>(alloc.allocate_bytes(n * sizeof(Entry), alignof(Entry)));
+    auto source = buffer;
+    auto source_capacity = capacity;
+    Relocate(target);
+    buffer   = target;
+    capacity = n;
+    if ((const std::byte*) source != storage) {
+        alloc.deallocate_bytes(source, source_capacity * sizeof(Entry), alignof(Entry));
+    }
+}
+
+/// @brief find the entry with exactly the given version
+/// @param version the version to look for
+/// @return the found entry, or end() if not found
+template<typename Entry, size_t N>
+typename VersionVector<Entry, N>::iterator VersionVector<Entry, N>::Find(size_t version) {
+    auto it = std::lower_bound(begin(), end(), version, [](const Entry& entry, size_t version) {
+        return entry.version < version;
+    });
+    return it != end() && it->version == version ? it : end();
+}
+
+/// @brief find the latest entry visible to the given version
+/// @param version the version of the reader
+/// @return the last entry with entry.version <= version, or end() if none
+template<typename Entry, size_t N>
+typename VersionVector<Entry, N>::iterator VersionVector<Entry, N>::Floor(size_t version) {
+    // writers mostly append, so check the newest entry before bisecting
+    if (!empty() && back().version <= version) { return end() - 1; }
+    auto it = std::upper_bound(begin(), end(), version, [](size_t version, const Entry& entry) {
+        return version < entry.version;
+    });
+    return it == begin() ? end() : it - 1;
+}
+
+/// @brief insert an entry at the position of its version
+/// @param entry the entry to insert, its version must not exist yet
+/// @return the inserted entry
+template<typename Entry, size_t N>
+typename VersionVector<Entry, N>::iterator VersionVector<Entry, N>::Insert(Entry&& entry) {
+    // prepend into the slack left by truncation
+    if (head != 0 && (empty() || entry.version < front().version)) {
+        new (buffer + --head) Entry(std::move(entry));
+        return begin();
+    }
+    auto offset = size_t(std::upper_bound(begin(), end(), entry.version, [](size_t version, const Entry& entry) {
+        return version < entry.version;
+    }) - begin());
+    MakeRoom();
+    auto pos = buffer + head + offset;
+    if (pos == end()) {
+        new (buffer + tail++) Entry(std::move(entry));
+        return pos;
+    }
+    new (buffer + tail) Entry(std::move(buffer[tail - 1]));
+    std::move_backward(pos, buffer + tail - 1, buffer + tail);
+    *pos = std::move(entry);
+    ++tail;
+    return pos;
+}
+
+/// @brief erase an entry
+/// @param it the entry to erase
+template<typename Entry, size_t N>
+void VersionVector<Entry, N>::Erase(iterator it) {
+    if (it == begin()) {
+        it->~Entry(); ++head;
+    }
+    else {
+        std::move(it + 1, end(), it);
+        buffer[--tail].~Entry();
+    }
+    if (empty()) { head = tail = 0; }
+}
+
+/// @brief drop all entries older than the given version
+/// @param version the oldest version to keep
+template<typename Entry, size_t N>
+void VersionVector<Entry, N>::TruncateBefore(size_t version) {
+    auto it = std::lower_bound(begin(), end(), version, [](const Entry& entry, size_t version) {
+        return entry.version < version;
+    });
+    std::destroy(begin(), it);
+    head = it - buffer;
+    if (empty()) { head = tail = 0; }
+}
+
+} // namespace spectrum
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <spectrum/common/version-list.hpp>
+#include <memory_resource>
+#include <vector>
+#include <memory>
+
+namespace {
+
+using namespace spectrum;
+
+struct Entry {
+    size_t                  version;
+    std::unique_ptr<size_t> value;
+};
+
+std::vector<size_t> Versions(VersionVector<Entry>& entries) {
+    auto versions = std::vector<size_t>();
+    for (auto& entry: entries) { versions.push_back(entry.version); }
+    return versions;
+}
+
+TEST(VersionVector, InsertSorted) {
+    auto arena = std::pmr::unsynchronized_pool_resource();
+    auto entries = VersionVector<Entry>(&arena);
+    for (auto v: {5, 1, 9, 3, 7, 2}) {
+        entries.Insert(Entry{size_t(v), std::make_unique<size_t>(v)});
+    }
+    ASSERT_EQ(Versions(entries), (std::vector<size_t>{1, 2, 3, 5, 7, 9}));
+    for (auto& entry: entries) { ASSERT_EQ(*entry.value, entry.version); }
+}
+
+TEST(VersionVector, FindAndFloor) {
+    auto entries = VersionVector<Entry>();
+    for (auto v: {2, 4, 6}) {
+        entries.Insert(Entry{size_t(v), nullptr});
+    }
+    ASSERT_EQ(entries.Find(4)->version, 4);
+    ASSERT_EQ(entries.Find(5), entries.end());
+    ASSERT_EQ(entries.Floor(1), entries.end());
+    ASSERT_EQ(entries.Floor(2)->version, 2);
+    ASSERT_EQ(entries.Floor(5)->version, 4);
+    ASSERT_EQ(entries.Floor(100)->version, 6);
+}
+
+TEST(VersionVector, EraseAndTruncate) {
+    auto arena = std::pmr::unsynchronized_pool_resource();
+    auto entries = VersionVector<Entry>(&arena);
+    for (size_t v = 1; v <= 10; ++v) {
+        entries.Insert(Entry{v, std::make_unique<size_t>(v)});
+    }
+    entries.Erase(entries.Find(5));
+    entries.Erase(entries.Find(1));
+    ASSERT_EQ(Versions(entries), (std::vector<size_t>{2, 3, 4, 6, 7, 8, 9, 10}));
+    entries.TruncateBefore(7);
+    ASSERT_EQ(Versions(entries), (std::vector<size_t>{7, 8, 9, 10}));
+    // prepend into the slack and append after compaction
+    entries.Insert(Entry{3, std::make_unique<size_t>(3)});
+    for (size_t v = 11; v <= 20; ++v) {
+        entries.Insert(Entry{v, std::make_unique<size_t>(v)});
+    }
+    ASSERT_EQ(entries.size(), 15);
+    ASSERT_EQ(entries.front().version, 3);
+    ASSERT_EQ(entries.back().version, 20);
+    for (auto& entry: entries) { ASSERT_EQ(*entry.value, entry.version); }
+    entries.TruncateBefore(100);
+    ASSERT_TRUE(entries.empty());
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace spectrum {
+
+/// @brief hint the cpu that we are spinning, so the sibling hyperthread gets the pipeline
+inline void CpuRelax() {
+    #if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+    #elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+    #endif
+}
+
+/// @brief exponential backoff, first pausing, then yielding, then asking the caller to park
+class Backoff {
+
+    static constexpr size_t spin_rounds  = 10;
+    static constexpr size_t yield_rounds = 16;
+
+    private:
+    size_t  round{0};
+
+    public:
+    /// @brief back off once
+    /// @return false if the caller should park instead of spinning again
+    bool Pause() {
+        if (round < spin_rounds) {
+            for (size_t i = 0; i < (size_t{1} << round); ++i) { CpuRelax(); }
+            ++round; return true;
+        }
+        if (round < spin_rounds + yield_rounds) {
+            std::this_thread::yield();
+            ++round; return true;
+        }
+        return false;
+    }
+    void Reset() { round = 0; }
+
+};
+
+/// @brief an event count: waiters spin, then park until some state they depend on is notified
+class Signal {
+
+    private:
+    std::atomic<uint32_t>   epoch{0};
+    std::atomic<uint32_t>   waiters{0};
+
+    public:
+    /// @brief wake up parked waiters, call after changing the state they wait on
+    void Notify() {
+        // pairs with the fence in Wait, so either the waiter sees our state or we see the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0) { return; }
+        epoch.fetch_add(1, std::memory_order_release);
+        epoch.notify_all();
+    }
+    /// @brief wait until a predicate holds
+    /// @param ready the predicate, it must be notified through this signal whenever it may turn true
+    template<typename Pred>
+    void Wait(Pred&& ready) {
+        auto backoff = Backoff();
+        while (!ready()) {
+            if (backoff.Pause()) { continue; }
+            waiters.fetch_add(1, std::memory_order_relaxed);
+            auto observed = epoch.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!ready()) { epoch.wait(observed, std::memory_order_acquire); }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+};
+
+/// @brief spin with backoff, then park until an atomic holds a value
+/// @param word the atomic to wait on, its writer must call notify_all after storing
+/// @param value the value to wait for
+template<typename A>
+void WaitFor(const std::atomic<A>& word, A value) {
+    auto backoff = Backoff();
+    for (auto current = word.load(); current != value; current = word.load()) {
+        if (backoff.Pause()) { continue; }
+        word.wait(current);
+    }
+}
+
+} // namespace spectrum
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <spectrum/common/wait-util.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+namespace {
+
+using namespace spectrum;
+using namespace std::chrono_literals;
+
+TEST(Backoff, EventuallyAsksToPark) {
+    auto backoff = Backoff();
+    auto rounds  = size_t{0};
+    while (backoff.Pause()) { ++rounds; }
+    ASSERT_GT(rounds, 0);
+    backoff.Reset();
+    ASSERT_TRUE(backoff.Pause());
+}
+
+TEST(Signal, WakeParkedWaiters) {
+    auto signal  = Signal();
+    auto counter = std::atomic<size_t>{0};
+    auto woken   = std::atomic<size_t>{0};
+    auto waiters = std::vector<std::thread>();
+    for (size_t i = 1; i <= 4; ++i) {
+        waiters.emplace_back([&, i]{
+            signal.Wait([&]{ return counter.load() >= i; });
+            woken.fetch_add(1);
+        });
+    }
+    // give waiters enough time to exhaust spinning and park
+    std::this_thread::sleep_for(50ms);
+    ASSERT_EQ(woken.load(), 0);
+    for (size_t i = 1; i <= 4; ++i) {
+        counter.store(i);
+        signal.Notify();
+    }
+    for (auto& t: waiters) { t.join(); }
+    ASSERT_EQ(woken.load(), 4);
+}
+
+TEST(Signal, PingPong) {
+    // two threads hand a token back and forth, so every wait depends on a notify
+    auto signal = Signal();
+    auto token  = std::atomic<size_t>{0};
+    auto player = [&](size_t parity) {
+        for (size_t round = 0; round < 10000; ++round) {
+            signal.Wait([&]{ return token.load() % 2 == parity; });
+            token.fetch_add(1);
+            signal.Notify();
+        }
+    };
+    auto a = std::thread(player, 0);
+    auto b = std::thread(player, 1);
+    a.join(); b.join();
+    ASSERT_EQ(token.load(), 20000);
+}
+
+TEST(WaitFor, ParkOnAtomic) {
+    auto flag = std::atomic<bool>{false};
+    auto t = std::thread([&]{ WaitFor(flag, true); });
+    std::this_thread::sleep_for(20ms);
+    flag.store(true);
+    flag.notify_all();
+    t.join();
+}
+
+}
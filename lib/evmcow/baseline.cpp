@@ -10,6 +10,15 @@
 #include "./vm.hpp"
 #include <memory>
 #include <optional>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <glog/logging.h>
 
 #ifdef NDEBUG
@@ -83,15 +92,187 @@ CodeAnalysis analyze_eof1(bytes_view container)
 
     return CodeAnalysis{executable_code, std::move(header)};
 }
+
+void translate(CodeAnalysis& analysis, evmc_revision rev);
 }  // namespace
 
 CodeAnalysis analyze(evmc_revision rev, bytes_view code)
 {
     if (rev < EVMC_PRAGUE || !is_eof_container(code))
-        return analyze_legacy(code);
+    {
+        auto analysis = analyze_legacy(code);
+        translate(analysis, rev);
+        return analysis;
+    }
     return analyze_eof1(code);
 }
 
+namespace
+{
+/// An analyzed code, keeping a copy of the code to tell hash collisions apart.
+struct CachedAnalysis
+{
+    evmc_revision rev;
+    std::vector<uint8_t> code;
+    std::shared_ptr<const CodeAnalysis> analysis;
+};
+
+/// A code registered by pin_code, matched by its address alone.
+struct PinnedCode
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    evmc_revision rev = EVMC_FRONTIER;
+    std::atomic<const CodeAnalysis*> analysis{nullptr};  ///< Owned by analysis_cache.
+};
+
+/// The lookup counters of one thread. Only the owner writes them, with plain stores.
+struct LookupCounters
+{
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> nanoseconds{0};
+    LookupCounters();
+    ~LookupCounters();
+};
+
+constexpr size_t max_pinned_codes = 64;
+
+std::shared_mutex analysis_cache_mu;
+std::unordered_multimap<size_t, CachedAnalysis> analysis_cache;
+std::array<PinnedCode, max_pinned_codes> pinned_codes;
+std::atomic<size_t> num_pinned_codes{0};
+std::atomic<size_t> analysis_misses{0};
+std::atomic<size_t> analysis_nanoseconds{0};
+
+std::mutex lookup_counters_mu;
+std::vector<LookupCounters*> lookup_counters;
+size_t retired_hits = 0;
+size_t retired_nanoseconds = 0;
+
+LookupCounters::LookupCounters()
+{
+    std::lock_guard lock{lookup_counters_mu};
+    lookup_counters.push_back(this);
+}
+
+LookupCounters::~LookupCounters()
+{
+    std::lock_guard lock{lookup_counters_mu};
+    retired_hits += hits.load(std::memory_order_relaxed);
+    retired_nanoseconds += nanoseconds.load(std::memory_order_relaxed);
+    std::erase(lookup_counters, this);
+}
+
+void bump(std::atomic<size_t>& counter, size_t n) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const CodeAnalysis> find_analysis(size_t hash, evmc_revision rev, bytes_view code)
+{
+    auto [first, last] = analysis_cache.equal_range(hash);
+    for (auto it = first; it != last; ++it)
+    {
+        const auto& entry = it->second;
+        if (entry.rev == rev && entry.code.size() == code.size() &&
+            std::memcmp(entry.code.data(), code.data(), code.size()) == 0)
+            return entry.analysis;
+    }
+    return nullptr;
+}
+
+PinnedCode* find_pinned(evmc_revision rev, bytes_view code) noexcept
+{
+    const auto num_pinned = num_pinned_codes.load(std::memory_order_acquire);
+    for (size_t i = 0; i < num_pinned; ++i)
+    {
+        auto& pin = pinned_codes[i];
+        if (pin.data == code.data() && pin.size == code.size() && pin.rev == rev)
+            return &pin;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const CodeAnalysis> lookup_analysis(
+    evmc_revision rev, bytes_view code, LookupCounters& counters)
+{
+    // pinned code never moves or changes, so its address is enough to find the analysis
+    auto* pin = find_pinned(rev, code);
+    if (pin != nullptr)
+    {
+        if (const auto* analysis = pin->analysis.load(std::memory_order_acquire))
+        {
+            bump(counters.hits, 1);
+            // cached analyses live as long as the process, a handle without ownership skips the
+            // reference count shared by all threads
+            return {std::shared_ptr<const CodeAnalysis>{}, analysis};
+        }
+    }
+    const auto hash = std::hash<std::string_view>{}(
+        std::string_view{reinterpret_cast<const char*>(code.data()), code.size()}) ^ rev;
+    auto analysis = [&] {
+        std::shared_lock lock{analysis_cache_mu};
+        return find_analysis(hash, rev, code);
+    }();
+    if (analysis != nullptr)
+        bump(counters.hits, 1);
+    else
+    {
+        // analyze without the lock, a racing thread analyzing the same code loses and shares ours
+        const auto start = std::chrono::steady_clock::now();
+        analysis = std::make_shared<const CodeAnalysis>(analyze(rev, code));
+        analysis_nanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+            std::memory_order_relaxed);
+        analysis_misses.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock lock{analysis_cache_mu};
+        if (auto cached = find_analysis(hash, rev, code))
+            analysis = cached;
+        else
+            analysis_cache.emplace(hash, CachedAnalysis{rev, {code.begin(), code.end()}, analysis});
+    }
+    if (pin != nullptr)
+        pin->analysis.store(analysis.get(), std::memory_order_release);
+    return analysis;
+}
+}  // namespace
+
+void pin_code(evmc_revision rev, bytes_view code)
+{
+    std::unique_lock lock{analysis_cache_mu};
+    const auto num_pinned = num_pinned_codes.load(std::memory_order_relaxed);
+    if (find_pinned(rev, code) != nullptr || num_pinned == max_pinned_codes)
+        return;
+    auto& pin = pinned_codes[num_pinned];
+    pin.data = code.data();
+    pin.size = code.size();
+    pin.rev = rev;
+    num_pinned_codes.store(num_pinned + 1, std::memory_order_release);
+}
+
+std::shared_ptr<const CodeAnalysis> analyze_shared(evmc_revision rev, bytes_view code)
+{
+    thread_local LookupCounters counters;
+    const auto start = std::chrono::steady_clock::now();
+    auto analysis = lookup_analysis(rev, code, counters);
+    bump(counters.nanoseconds,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    return analysis;
+}
+
+AnalysisStats analysis_stats() noexcept
+{
+    std::lock_guard lock{lookup_counters_mu};
+    auto hits = retired_hits;
+    auto nanoseconds = retired_nanoseconds;
+    for (const auto* counters : lookup_counters)
+    {
+        hits += counters->hits.load(std::memory_order_relaxed);
+        nanoseconds += counters->nanoseconds.load(std::memory_order_relaxed);
+    }
+    return {hits, analysis_misses.load(), nanoseconds, analysis_nanoseconds.load()};
+}
+
 /// Checks instruction requirements before execution.
 ///
 /// This checks:
@@ -227,6 +408,354 @@ template <Opcode Op>
 }
 
 
+namespace
+{
+/// Threaded code.
+///
+/// Legacy code is translated once per analysis into a stream of instructions holding their
+/// handlers. A block instruction starts every basic block: it checks the stack and charges the base
+/// gas of the whole block, so the handlers within skip check_requirements(). PUSH data is decoded
+/// ahead of time, and frequent Solidity idioms are fused. Only the host calls behind SLOAD and
+/// SSTORE ask to break, so only they check state.will_break and save a position before running.
+///
+/// Blocks end after jumps, terminating instructions and instructions whose outcome depends on the
+/// gas left, so charging a block up front does not change what they observe.
+
+constexpr auto no_index = std::numeric_limits<uint32_t>::max();
+
+/// Leaves the interpreter at the given instruction, so resuming runs it again.
+[[release_inline]] inline const Instruction* leave(
+    const Instruction* instr, ExecutionState& state) noexcept
+{
+    state.position = Position{instr->pc};
+    return nullptr;
+}
+
+/// Finds the instruction translated from the given code position.
+[[release_inline]] inline const Instruction* resolve(
+    code_iterator pc, const CodeAnalysis& analysis) noexcept
+{
+    const auto i = analysis.threaded_index[static_cast<size_t>(pc - analysis.executable_code.data())];
+    assert(i != no_index);
+    return &analysis.threaded_code[i];
+}
+
+const Instruction* op_block(const Instruction* instr, int64_t& gas, ExecutionState& state) noexcept
+{
+    const auto height = static_cast<int64_t>(state.stack_top.height);
+    if (INTX_UNLIKELY(height + instr->stack_growth > StackSpace::limit))
+    {
+        state.status = EVMC_STACK_OVERFLOW;
+        return leave(instr, state);
+    }
+    if (INTX_UNLIKELY(height < instr->stack_required))
+    {
+        state.status = EVMC_STACK_UNDERFLOW;
+        return leave(instr, state);
+    }
+    if (INTX_UNLIKELY((gas -= instr->gas) < 0))
+    {
+        state.status = EVMC_OUT_OF_GAS;
+        return leave(instr, state);
+    }
+    return instr + 1;
+}
+
+const Instruction* op_undefined(
+    const Instruction* instr, int64_t& /*gas*/, ExecutionState& state) noexcept
+{
+    state.status = EVMC_UNDEFINED_INSTRUCTION;
+    return leave(instr, state);
+}
+
+template <Opcode Op>
+const Instruction* op_generic(const Instruction* instr, int64_t& gas, ExecutionState& state) noexcept
+{
+    const auto old_height = state.stack_top.height;
+    const auto next = invoke(instr::core::impl<Op>, Position{instr->pc}, gas, state);
+    if (instr::traits[Op].stack_height_change > 0) {
+        state.stack_top.height = old_height + instr::traits[Op].stack_height_change;
+    }
+    else {
+        state.stack_top.height = old_height - (-instr::traits[Op].stack_height_change);
+    }
+    if (next == nullptr)
+        return leave(instr, state);
+    // falling through may enter the next block, which its block instruction has to check
+    if (next == instr[1].pc)
+        return instr + 1;
+    return resolve(next, *state.analysis.baseline);
+}
+
+template <Opcode Op>
+const Instruction* op_storage(const Instruction* instr, int64_t& gas, ExecutionState& state) noexcept
+{
+    // checkpoints taken by the host save this position
+    state.position = Position{instr->pc};
+    const auto next = op_generic<Op>(instr, gas, state);
+    if (next != nullptr && state.will_break)
+    {
+        state.will_break = false;
+        state.position = Position{instr->pc + 1};
+        return nullptr;
+    }
+    return next;
+}
+
+const Instruction* op_push(const Instruction* instr, int64_t& /*gas*/, ExecutionState& state) noexcept
+{
+    state.stack_top.push(instr->immediate);
+    return instr + 1;
+}
+
+/// PUSH dst JUMP, with a valid destination
+const Instruction* op_push_jump(
+    const Instruction* instr, int64_t& /*gas*/, ExecutionState& state) noexcept
+{
+    return &state.analysis.baseline->threaded_code[instr->target];
+}
+
+/// PUSH dst JUMPI, with a valid destination
+const Instruction* op_push_jumpi(
+    const Instruction* instr, int64_t& /*gas*/, ExecutionState& state) noexcept
+{
+    const auto& cond = state.stack_top.pop();
+    return cond ? &state.analysis.baseline->threaded_code[instr->target] : instr + 1;
+}
+
+/// PUSH x ADD
+const Instruction* op_push_add(
+    const Instruction* instr, int64_t& /*gas*/, ExecutionState& state) noexcept
+{
+    state.stack_top.get_mut(0) += instr->immediate;
+    return instr + 1;
+}
+
+/// DUP2 MSTORE, which stores a mapping key or slot before KECCAK256
+const Instruction* op_dup2_mstore(
+    const Instruction* instr, int64_t& gas, ExecutionState& state) noexcept
+{
+    auto& stack = state.stack_top;
+    const auto& value = stack.get(0);
+    const auto& index = stack.get(1);
+    if (!check_memory(gas, state.memory, index, 32))
+    {
+        state.status = EVMC_OUT_OF_GAS;
+        return leave(instr, state);
+    }
+    state.memory.touch(static_cast<size_t>(index), 32);
+    intx::be::unsafe::store(&state.memory[static_cast<size_t>(index)], value);
+    stack.pop();
+    return instr + 1;
+}
+
+/// SWAP1 POP
+const Instruction* op_swap1_pop(
+    const Instruction* instr, int64_t& /*gas*/, ExecutionState& state) noexcept
+{
+    auto& stack = state.stack_top;
+    const auto top = stack.pop();
+    stack.get_mut(0) = top;
+    return instr + 1;
+}
+
+/// POP POP
+const Instruction* op_pop_pop(
+    const Instruction* instr, int64_t& /*gas*/, ExecutionState& state) noexcept
+{
+    state.stack_top.pop();
+    state.stack_top.pop();
+    return instr + 1;
+}
+
+Handler generic_handler(uint8_t op) noexcept
+{
+    if (op == OP_SLOAD)
+        return op_storage<OP_SLOAD>;
+    if (op == OP_SSTORE)
+        return op_storage<OP_SSTORE>;
+    switch (op)
+    {
+#define ON_OPCODE(OPCODE) \
+    case OPCODE:          \
+        return op_generic<OPCODE>;
+        MAP_OPCODES
+#undef ON_OPCODE
+    default:
+        return op_undefined;
+    }
+}
+
+/// Checks if the instruction ends a basic block.
+bool ends_block(uint8_t op) noexcept
+{
+    switch (op)
+    {
+    case OP_JUMP:
+    case OP_JUMPI:
+    case OP_GAS:
+    case OP_SLOAD:
+    case OP_SSTORE:
+    case OP_CALL:
+    case OP_CALLCODE:
+    case OP_DELEGATECALL:
+    case OP_STATICCALL:
+    case OP_CREATE:
+    case OP_CREATE2:
+        return true;
+    default:
+        return instr::traits[op].is_terminating;
+    }
+}
+
+/// Decodes the data of a PUSH instruction from padded code.
+uint256 push_data(const uint8_t* data, size_t len) noexcept
+{
+    auto value = uint256{0};
+    for (size_t i = 0; i < len; ++i)
+        value = (value << 8) | uint256{data[i]};
+    return value;
+}
+
+void translate(CodeAnalysis& analysis, evmc_revision rev)
+{
+    const auto& cost_table = get_baseline_cost_table(rev, 0);
+    const auto* code = analysis.executable_code.data();
+    const auto size = analysis.executable_code.size();
+    auto& stream = analysis.threaded_code;
+    auto& index = analysis.threaded_index;
+    index.assign(size + 1, no_index);
+
+    auto block = size_t{0};        // the current block instruction
+    auto open = false;             // if the current block takes more instructions
+    auto height = int64_t{0};      // the stack height change since the block started
+    auto jumps = std::vector<size_t>();  // constant jumps, with code positions as targets yet
+    const auto begin = [&](size_t pc) {
+        block = stream.size();
+        index[pc] = static_cast<uint32_t>(block);
+        stream.push_back({.fn = op_block, .pc = code + pc});
+        open = true;
+        height = 0;
+    };
+    const auto charge = [&](uint8_t op) {
+        auto& b = stream[block];
+        const auto& traits = instr::traits[op];
+        b.gas += cost_table[op];
+        b.stack_required = std::max<int32_t>(b.stack_required, static_cast<int32_t>(traits.stack_height_required - height));
+        height += traits.stack_height_change;
+        b.stack_growth = std::max<int32_t>(b.stack_growth, static_cast<int32_t>(height));
+    };
+    const auto emit = [&](size_t pc, Instruction instr) {
+        if (index[pc] == no_index)
+            index[pc] = static_cast<uint32_t>(stream.size());
+        stream.push_back(instr);
+    };
+    const auto valid = [&](size_t pc) { return pc < size && cost_table[code[pc]] >= 0; };
+
+    for (size_t pc = 0; pc < size;)
+    {
+        const auto op = code[pc];
+        if (!open || op == OP_JUMPDEST)
+            begin(pc);
+        if (cost_table[op] < 0)
+        {
+            emit(pc, {.fn = op_undefined, .pc = code + pc});
+            open = false;
+            pc += 1;
+            continue;
+        }
+        charge(op);
+        if (op == OP_JUMPDEST)
+        {
+            stream[block].count += 1;
+            pc += 1;
+            continue;
+        }
+        if (op >= OP_PUSH1 && op <= OP_PUSH32)
+        {
+            const auto len = size_t{op} - OP_PUSH1 + 1;
+            const auto value = push_data(code + pc + 1, len);
+            const auto next = pc + 1 + len;
+            const auto fused = valid(next) ? code[next] : uint8_t{OP_JUMPDEST};
+            const auto dst = value < size ? static_cast<size_t>(value) : size;
+            if ((fused == OP_JUMP || fused == OP_JUMPI) && dst < size && analysis.jumpdest_map[dst])
+            {
+                charge(fused);
+                jumps.push_back(stream.size());
+                emit(pc, {.fn = fused == OP_JUMP ? op_push_jump : op_push_jumpi, .pc = code + pc,
+                             .count = 2, .target = static_cast<uint32_t>(dst)});
+                index[next] = index[pc];
+                open = false;
+                pc = next + 1;
+                continue;
+            }
+            if (fused == OP_ADD)
+            {
+                charge(fused);
+                emit(pc, {.fn = op_push_add, .pc = code + pc, .count = 2, .immediate = value});
+                index[next] = index[pc];
+                pc = next + 1;
+                continue;
+            }
+            emit(pc, {.fn = op_push, .pc = code + pc, .count = 1, .immediate = value});
+            pc = next;
+            continue;
+        }
+        if (op == OP_PUSH0)
+        {
+            emit(pc, {.fn = op_push, .pc = code + pc, .count = 1});
+            pc += 1;
+            continue;
+        }
+        const auto next = pc + 1;
+        const auto fused = valid(next) ? code[next] : uint8_t{OP_JUMPDEST};
+        const auto pair = op == OP_DUP2 && fused == OP_MSTORE   ? op_dup2_mstore :
+                          op == OP_SWAP1 && fused == OP_POP     ? op_swap1_pop :
+                          op == OP_POP && fused == OP_POP       ? op_pop_pop :
+                                                                  Handler{nullptr};
+        if (pair != nullptr)
+        {
+            charge(fused);
+            emit(pc, {.fn = pair, .pc = code + pc, .count = 2});
+            index[next] = index[pc];
+            pc = next + 1;
+            continue;
+        }
+        emit(pc, {.fn = generic_handler(op), .pc = code + pc, .count = 1});
+        if (ends_block(op))
+            open = false;
+        pc = next;
+    }
+    // the padding after the code is STOP, running off the end stops there
+    if (!open)
+        begin(size);
+    charge(OP_STOP);
+    emit(size, {.fn = op_generic<OP_STOP>, .pc = code + size, .count = 1});
+
+    for (const auto i : jumps)
+        stream[i].target = index[stream[i].target];
+}
+}  // namespace
+
+/// Runs threaded code, see translate().
+int64_t dispatch_threaded(ExecutionState& state, int64_t gas, VM& vm) noexcept
+{
+    const auto& analysis = *state.analysis.baseline;
+    const auto* instr = &analysis.threaded_code[0];
+    if (state.position != std::nullopt)
+    {
+        // we left the interpreter in a previous execution, or a checkpoint was loaded
+        instr = resolve(state.position->code_it, analysis);
+        state.position = std::nullopt;
+    }
+    while (instr != nullptr)
+    {
+        vm.op_count += instr->count;
+        instr = instr->fn(instr, gas, state);
+    }
+    return gas;
+}
+
 template <bool TracingEnabled>
 int64_t dispatch(const CostTable& cost_table, ExecutionState& state, int64_t gas,
     const uint8_t* code, VM& vm, Tracer* tracer = nullptr) noexcept
@@ -332,6 +861,10 @@ evmc_result execute(
         tracer->notify_execution_start(state.rev, *state.msg, vm.analysis->executable_code);
         gas = dispatch<true>(cost_table, state, gas, code.data(), vm, tracer);
     }
+    else if (vm.threaded && !vm.analysis->threaded_code.empty())
+    {
+        gas = dispatch_threaded(state, gas, vm);
+    }
     else
     {
         gas = dispatch<false>(cost_table, state, gas, code.data(), vm);
@@ -360,7 +893,7 @@ evmc_result execute(VM& vm, const evmc_host_interface* host, evmc_host_context*
             return evmc_make_result(EVMC_CONTRACT_VALIDATION_FAILURE, 0, 0, nullptr, 0);
     }
     if (vm.analysis.get() == nullptr) {
-        vm.analysis = std::make_unique<CodeAnalysis>(analyze(rev, container));
+        vm.analysis = analyze_shared(rev, container);
     }
     const auto data = vm.analysis->eof_header.get_data(container);
     ExecutionState& state = *([&]{
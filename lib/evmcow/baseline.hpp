@@ -6,6 +6,7 @@
 #include "./eof.hpp"
 #include <evmc/evmc.h>
 #include <evmc/utils.h>
+#include <intx/intx.hpp>
 #include <memory>
 #include <string_view>
 #include <vector>
@@ -19,6 +20,27 @@ class VM;
 
 namespace baseline
 {
+struct Instruction;
+
+/// The handler of a threaded-code instruction.
+/// Returns the next instruction to run, or nullptr to leave the interpreter.
+using Handler = const Instruction* (*)(
+    const Instruction* instr, int64_t& gas, ExecutionState& state) noexcept;
+
+/// An instruction of the threaded code, translated from one or a few fused EVM instructions,
+/// or the block instruction that starts every basic block.
+struct Instruction
+{
+    Handler fn = nullptr;         ///< The handler running this instruction.
+    const uint8_t* pc = nullptr;  ///< The position of the first EVM instruction it stands for.
+    uint32_t count = 0;           ///< The number of EVM instructions it stands for.
+    uint32_t target = 0;          ///< The instruction a constant jump goes to.
+    int64_t gas = 0;              ///< Blocks only: the base gas cost of the whole block.
+    int32_t stack_required = 0;   ///< Blocks only: the stack height needed on entry.
+    int32_t stack_growth = 0;     ///< Blocks only: the largest stack height increase within.
+    intx::uint256 immediate{};    ///< The decoded PUSH data.
+};
+
 class CodeAnalysis
 {
 public:
@@ -28,6 +50,12 @@ public:
     JumpdestMap jumpdest_map;    ///< Map of valid jump destinations.
     EOF1Header eof_header;       ///< The EOF header.
 
+    /// The threaded code of legacy code, empty for EOF code.
+    std::vector<Instruction> threaded_code;
+    /// Maps a code position to the instruction translated from it.
+    /// Positions starting a basic block map to the block instruction.
+    std::vector<uint32_t> threaded_index;
+
 private:
     /// Padded code for faster legacy code execution.
     /// If not nullptr the executable_code must point to it.
@@ -52,6 +80,27 @@ static_assert(!std::is_copy_assignable_v<CodeAnalysis>);
 /// Analyze the code to build the bitmap of valid JUMPDEST locations.
 EVMC_EXPORT CodeAnalysis analyze(evmc_revision rev, bytes_view code);
 
+/// Analyze the code once per process. Later calls with the same code and revision share the analysis.
+/// Thread-safe.
+EVMC_EXPORT std::shared_ptr<const CodeAnalysis> analyze_shared(evmc_revision rev, bytes_view code);
+
+/// Promise that the code stays at its address, unchanged, until the process exits.
+/// analyze_shared then finds its analysis by address, without hashing, comparing or locking.
+/// Thread-safe.
+EVMC_EXPORT void pin_code(evmc_revision rev, bytes_view code);
+
+/// The counters of analyze_shared, which only runs analyze on a miss.
+struct AnalysisStats
+{
+    size_t hits;                 ///< Calls served from the cache.
+    size_t misses;               ///< Calls that ran analyze.
+    size_t nanoseconds;          ///< Time spent in analyze_shared, lookups included.
+    size_t analyze_nanoseconds;  ///< Time spent in analyze.
+};
+
+/// The counters of analyze_shared so far.
+EVMC_EXPORT AnalysisStats analysis_stats() noexcept;
+
 /// Executes in Baseline interpreter using EVMC-compatible parameters. (deprecated)
 evmc_result execute(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* ctx,
     evmc_revision rev, const evmc_message* msg, const uint8_t* code, size_t code_size) noexcept;
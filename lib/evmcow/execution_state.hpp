@@ -8,6 +8,10 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <algorithm>
 #include <glog/logging.h>
 
 namespace evmcow
@@ -40,12 +44,24 @@ public:
     alignas(sizeof(uint256)) uint256 m_stack_space[limit];
 };
 
+/// The default number of stack items in a copy-on-write slice.
 const static size_t SLICE = size_t(2);
 
 /// COW Stack implementation
-class StackTop
+///
+/// The stack is a table of slices, each holding S items, bump-allocated from a stack space and
+/// shared with checkpoints. Since the space only grows, the slices this stack top owns are exactly
+/// those allocated since its last checkpoint. So instead of one ownership flag per slice it keeps
+/// a single watermark into the space: a slice below owned_from is shared (or not allocated yet) and
+/// is copied before it is written, a slice above it is written in place.
+template<size_t S>
+class BasicStackTop
 {
+    static_assert(S > 0, "a slice holds at least one item");
+
 public:
+    /// number of slices covering the 1024 item EVM stack
+    static constexpr size_t num_slices = (1024 + S - 1) / S;
     /// stack height
     size_t height;
     /// space bottom
@@ -53,60 +69,53 @@ public:
     /// space limit
     uint256* limit;
     /// pointers to slices
-    std::array<uint256*, 1024/SLICE> slices;
-    /// ownership
-    std::array<bool, 1024/SLICE> ownership;
+    std::array<uint256*, num_slices> slices;
+    /// slices allocated from here on are owned by this stack top
+    uint256* owned_from;
     /// initialize a stack top for nothing
-    StackTop():
+    BasicStackTop():
         height{0},
         base{nullptr},
         limit{nullptr},
         slices{{nullptr}},
-        ownership{{false}}
+        owned_from{nullptr}
     {}
     /// initialize a stack top with given space
-    StackTop(uint256* base, uint256* limit): 
+    BasicStackTop(uint256* base, uint256* limit):
         height{0},
         base{base},
         limit{limit},
         slices{{nullptr}},
-        ownership{{false}}
+        owned_from{base}
     {}
     /// copy a stack top
-    StackTop(const StackTop& stack_top):
-        height{stack_top.height},
-        base{stack_top.base},
-        limit{stack_top.limit},
-        slices{stack_top.slices},
-        ownership{stack_top.ownership}
-    {}
+    BasicStackTop(const BasicStackTop& stack_top) = default;
+    BasicStackTop& operator=(const BasicStackTop& stack_top) = default;
+    /// give up ownership of every slice, after which this stack top shares them with its copies
+    inline void share() {
+        owned_from = base;
+    }
+    /// the number of slices allocated since the last share
+    [[nodiscard]] inline size_t owned() const {
+        return static_cast<size_t>(base - owned_from) / S;
+    }
     /// declare ownership of a slice
     inline void ensure(size_t slice_index) {
-        if (ownership[slice_index] && slices[slice_index]) {
-            return;
-        }
-        uint256* old_slice  = slices[slice_index];
-        slices[slice_index] = base;
-        uint256* new_slice  = base;
-        ownership[slice_index] = true;
-        base += SLICE;
-        if (base > limit) {
-            LOG(FATAL) << "exceed stack height limit";
-        }
-        if (old_slice != nullptr) {
-            memcpy(new_slice, old_slice, SLICE * sizeof(uint256));
+        // unallocated slices are null, which also falls below the watermark
+        if (INTX_UNLIKELY(std::less<uint256*>{}(slices[slice_index], owned_from))) {
+            ensure_slow(slice_index);
         }
     }
     /// push an item onto current stack top
     inline void push(const uint256& item) {
-        ensure(height / SLICE);
-        slices[height / SLICE][height % SLICE] = item;
+        ensure(height / S);
+        slices[height / S][height % S] = item;
         height += 1;
     }
     /// pop an item and return it
     inline const uint256 &pop() {
         height -= 1;
-        return slices[height / SLICE][height % SLICE];
+        return slices[height / S][height % S];
     }
     /// equivalent to get(0)
     inline const uint256& top() {
@@ -119,31 +128,97 @@ public:
     /// read item on stack, counting from stack top to stack bottom
     inline const uint256& get(size_t index) const {
         index = height - 1 - index;
-        return slices[index / SLICE][index % SLICE];
+        return slices[index / S][index % S];
     }
     /// write item to stack
     inline uint256& get_mut(size_t index) {
         index = height - 1 - index;
-        ensure(index / SLICE);
-        return slices[index / SLICE][index % SLICE];
+        ensure(index / S);
+        return slices[index / S][index % S];
+    }
+
+private:
+    /// copy a shared slice into fresh space, or back an unallocated slice with space
+    [[gnu::noinline]] void ensure_slow(size_t slice_index) {
+        uint256* old_slice  = slices[slice_index];
+        uint256* new_slice  = base;
+        slices[slice_index] = new_slice;
+        base += S;
+        if (base > limit) {
+            LOG(FATAL) << "exceed stack height limit";
+        }
+        // items at or above the height are dead, only a slice under the height carries any
+        if (old_slice != nullptr && slice_index * S < height) {
+            memcpy(new_slice, old_slice, S * sizeof(uint256));
+        }
     }
 };
 
+using StackTop = BasicStackTop<SLICE>;
+
 /// The EVM memory.
 ///
 /// The implementations uses initial allocation of 4k and then grows capacity with 2x factor.
 /// Some benchmarks has been done to confirm 4k is ok-ish value.
+///
+/// Memory stays one flat buffer, so reads and copies out of it are unchanged. Checkpoints are
+/// taken copy-on-write at the granularity of cow_page bytes: after a mark(), the first write to a
+/// page saves its old contents to an undo log, and rollback() restores the saved pages in
+/// reverse order and truncates memory to its size at the mark. Writers call touch() on the
+/// range they are about to write.
 class Memory
 {
     /// The size of allocation "page".
     static constexpr size_t page_size = 4 * 1024;
 
+public:
+    /// The granularity of copy-on-write checkpoints.
+    static constexpr size_t cow_page = 256;
+
+    /// A memory checkpoint, the size and the undo log length at the time it was taken.
+    struct Mark
+    {
+        size_t size = 0;
+        size_t undo_size = 0;
+    };
+
+private:
+    /// A page saved to the undo log, its bytes are at the end of m_undo_bytes.
+    struct Saved
+    {
+        size_t page;
+        size_t length;
+    };
+
     /// The "virtual" size of the memory.
     size_t m_size = 0;
 
     /// Actual allocated memory.
     std::vector<uint8_t> m_data;
 
+    /// The epoch in which each page was last saved or created.
+    std::vector<uint32_t> m_page_epoch;
+
+    /// The current epoch, bumped by every mark and rollback. Zero means no checkpoint was taken.
+    uint32_t m_epoch = 0;
+
+    /// Saved pages, and their old contents packed back to back.
+    std::vector<Saved> m_undo;
+    std::vector<uint8_t> m_undo_bytes;
+
+    /// The length of the undo log at the latest mark.
+    size_t m_marked_bytes = 0;
+
+    /// Saves a page before its first write in the current epoch.
+    [[gnu::noinline]] void save(size_t page) noexcept
+    {
+        const auto begin = page * cow_page;
+        const auto length = std::min(cow_page, m_size - begin);
+        m_undo.push_back({page, length});
+        m_undo_bytes.insert(m_undo_bytes.end(), &m_data[begin], &m_data[begin] + length);
+        m_page_epoch[page] = m_epoch;
+    }
+
 public:
     /// Creates Memory object with initial capacity allocation.
     Memory() noexcept: m_data{std::vector<uint8_t>(page_size)} { }
@@ -174,16 +249,74 @@ public:
 
         m_data.resize(new_size, 0);
         m_size = new_size;
+        // New pages are cut off by a rollback, so they never need saving.
+        m_page_epoch.resize((new_size + cow_page - 1) / cow_page, m_epoch);
+    }
+
+    /// Prepares a range for writing, saving the pages not written since the latest mark.
+    ///
+    /// @param offset  The start of the range, the range must be within the memory size.
+    /// @param size    The length of the range.
+    void touch(size_t offset, size_t size) noexcept
+    {
+        if (INTX_LIKELY(m_epoch == 0) || size == 0)
+            return;
+        for (auto page = offset / cow_page; page <= (offset + size - 1) / cow_page; ++page)
+        {
+            if (m_page_epoch[page] != m_epoch)
+                save(page);
+        }
+    }
+
+    /// Takes a checkpoint, later writes save the pages they touch first.
+    Mark mark() noexcept
+    {
+        m_epoch += 1;
+        m_marked_bytes = m_undo_bytes.size();
+        return {m_size, m_undo.size()};
+    }
+
+    /// Restores the memory as it was at a mark, dropping the marks taken after it.
+    void rollback(const Mark& mark) noexcept
+    {
+        while (m_undo.size() > mark.undo_size)
+        {
+            const auto saved = m_undo.back();
+            const auto bytes = m_undo_bytes.size() - saved.length;
+            std::memcpy(&m_data[saved.page * cow_page], &m_undo_bytes[bytes], saved.length);
+            m_undo_bytes.resize(bytes);
+            m_undo.pop_back();
+        }
+        m_size = mark.size;
+        m_data.resize(mark.size);
+        m_page_epoch.resize((mark.size + cow_page - 1) / cow_page);
+        // Start a fresh epoch, pages saved since the mark were just restored.
+        m_epoch += 1;
+        m_marked_bytes = m_undo_bytes.size();
     }
 
-    /// Virtually clears the memory by setting its size to 0. The capacity stays unchanged.
-    void clear() noexcept { m_size = 0; }
+    /// The number of bytes saved since the latest mark.
+    [[nodiscard]] size_t saved() const noexcept { return m_undo_bytes.size() - m_marked_bytes; }
+
+    /// Clears the memory by setting its size to 0. The capacity stays unchanged, so the next grow
+    /// zero-fills without allocating.
+    void clear() noexcept
+    {
+        m_size = 0;
+        m_data.clear();
+        m_page_epoch.clear();
+        m_epoch = 0;
+        m_undo.clear();
+        m_undo_bytes.clear();
+        m_marked_bytes = 0;
+    }
 };
 
 /// Checkpoint of an execution state
 struct Checkpoint {
     code_iterator code_it;
     StackTop    stack;
+    Memory::Mark memory;
 };
 
 /// The execution position.
@@ -279,14 +412,16 @@ public:
         auto checkpoint = Checkpoint{
             .code_it = this->position.value().code_it,
             .stack   = this->stack_top,
+            .memory  = this->memory.mark(),
         };
-        this->stack_top.ownership = std::array<bool, 1024/SLICE>{{false}};
+        this->stack_top.share();
         return checkpoint;
     }
 
     /// Load a checkpoint
     inline void load_checkpoint(const Checkpoint& checkpoint) {
         this->stack_top = checkpoint.stack;
+        this->memory.rollback(checkpoint.memory);
         this->position  = std::optional{Position{checkpoint.code_it}};
     }
 
@@ -308,6 +443,12 @@ public:
         output_offset = 0;
         output_size = 0;
         m_tx = {};
+        will_break = false;
+        call_stack.clear();
+        stack_top = StackTop(
+            &stack_space.m_stack_space[0], 
+            &stack_space.m_stack_space[stack_space.limit]
+        );
     }
 
     [[nodiscard]] bool in_static_mode() const { return (msg->flags & EVMC_STATIC) != 0; }
@@ -8,10 +8,12 @@
 
 namespace {
 
-TEST(EVMCOWState, StackTop) {
+// random pushes, writes, pops and checkpoints, checked against a stack of vectors
+template<size_t S>
+void RandomStackTop() {
     for (size_t j = 0; j < 100; ++j) {
         auto stack_space  = evmcow::StackSpace();
-        auto stack_of_top = std::vector{evmcow::StackTop(&stack_space.m_stack_space[0], &stack_space.m_stack_space[0] + stack_space.limit)};
+        auto stack_of_top = std::vector{evmcow::BasicStackTop<S>(&stack_space.m_stack_space[0], &stack_space.m_stack_space[0] + stack_space.limit)};
         auto stack_of_vec = std::vector<std::vector<evmcow::uint256>>(1);
         for (size_t i = 0; i < 1024; ++i) {
             auto a = std::rand() % std::max(stack_of_vec.back().size(), size_t{1});
@@ -40,7 +42,7 @@ TEST(EVMCOWState, StackTop) {
                 case 7:
                     stack_of_vec.push_back(stack_of_vec.back());
                     stack_of_top.push_back(stack_of_top.back());
-                    stack_of_top.back().ownership = {false};
+                    stack_of_top.back().share();
                     break;
             }
         }
@@ -52,4 +54,65 @@ TEST(EVMCOWState, StackTop) {
     }
 }
 
+TEST(EVMCOWState, StackTop) {
+    RandomStackTop<evmcow::SLICE>();
+}
+
+TEST(EVMCOWState, StackTopSliceSizes) {
+    RandomStackTop<1>();
+    RandomStackTop<3>();
+    RandomStackTop<8>();
+}
+
+TEST(EVMCOWState, MemoryRollback) {
+    for (size_t j = 0; j < 100; ++j) {
+        auto memory = evmcow::Memory();
+        auto marks  = std::vector<evmcow::Memory::Mark>();
+        // the expected memory at each mark, and the expected memory now
+        auto copies = std::vector<std::vector<uint8_t>>();
+        auto expect = std::vector<uint8_t>();
+        for (size_t i = 0; i < 256; ++i) {
+            switch (std::rand() % 8) {
+                case 0:
+                case 1: {
+                    auto size = expect.size() + 32 * (1 + std::rand() % 16);
+                    memory.grow(size);
+                    expect.resize(size, 0);
+                    break;
+                }
+                case 2:
+                case 3:
+                case 4: {
+                    if (expect.size() == 0) break;
+                    auto offset = std::rand() % expect.size();
+                    auto size   = std::rand() % std::min(expect.size() - offset, size_t{600});
+                    memory.touch(offset, size);
+                    for (size_t k = offset; k < offset + size; ++k) {
+                        memory[k] = expect[k] = std::rand() % 256;
+                    }
+                    break;
+                }
+                case 5:
+                case 6:
+                    marks.push_back(memory.mark());
+                    copies.push_back(expect);
+                    break;
+                case 7: {
+                    if (marks.size() == 0) break;
+                    auto k = std::rand() % marks.size();
+                    memory.rollback(marks[k]);
+                    expect = copies[k];
+                    marks.resize(k);
+                    copies.resize(k);
+                    break;
+                }
+            }
+            ASSERT_EQ(memory.size(), expect.size());
+            for (size_t k = 0; k < expect.size(); ++k) {
+                ASSERT_EQ(memory[k], expect[k]) << "byte " << k;
+            }
+        }
+    }
+}
+
 } // namespace
\ No newline at end of file
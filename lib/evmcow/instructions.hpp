@@ -421,6 +421,7 @@ inline Result calldatacopy(StackTop& stack, int64_t gas_left, ExecutionState& st
     if (const auto cost = copy_cost(s); (gas_left -= cost) < 0)
         return {EVMC_OUT_OF_GAS, gas_left};
 
+    state.memory.touch(dst, s);
     if (copy_size > 0)
         std::memcpy(&state.memory[dst], &state.msg->input_data[src], copy_size);
 
@@ -456,6 +457,7 @@ inline Result codecopy(StackTop& stack, int64_t gas_left, ExecutionState& state)
         return {EVMC_OUT_OF_GAS, gas_left};
 
     // TODO: Add unit tests for each combination of conditions.
+    state.memory.touch(dst, s);
     if (copy_size > 0)
         std::memcpy(&state.memory[dst], &state.original_code[src], copy_size);
 
@@ -531,6 +533,7 @@ inline Result extcodecopy(StackTop& stack, int64_t gas_left, ExecutionState& sta
         const auto src =
             (max_buffer_size < input_index) ? max_buffer_size : static_cast<size_t>(input_index);
         const auto dst = static_cast<size_t>(mem_index);
+        state.memory.touch(dst, s);
         const auto num_bytes_copied = state.host.copy_code(addr, src, &state.memory[dst], s);
         if (const auto num_bytes_to_clear = s - num_bytes_copied; num_bytes_to_clear > 0)
             std::memset(&state.memory[dst + num_bytes_copied], 0, num_bytes_to_clear);
@@ -588,6 +591,7 @@ inline Result returndatacopy(StackTop& stack, int64_t gas_left, ExecutionState&
     if (const auto cost = copy_cost(s); (gas_left -= cost) < 0)
         return {EVMC_OUT_OF_GAS, gas_left};
 
+    state.memory.touch(dst, s);
     if (s > 0)
         std::memcpy(&state.memory[dst], &state.return_data[src], s);
 
@@ -679,6 +683,7 @@ inline Result mstore(StackTop& stack, int64_t gas_left, ExecutionState& state) n
     if (!check_memory(gas_left, state.memory, index, 32))
         return {EVMC_OUT_OF_GAS, gas_left};
 
+    state.memory.touch(static_cast<size_t>(index), 32);
     intx::be::unsafe::store(&state.memory[static_cast<size_t>(index)], value);
     return {EVMC_SUCCESS, gas_left};
 }
@@ -691,6 +696,7 @@ inline Result mstore8(StackTop& stack, int64_t gas_left, ExecutionState& state)
     if (!check_memory(gas_left, state.memory, index, 1))
         return {EVMC_OUT_OF_GAS, gas_left};
 
+    state.memory.touch(static_cast<size_t>(index), 1);
     state.memory[static_cast<size_t>(index)] = static_cast<uint8_t>(value);
     return {EVMC_SUCCESS, gas_left};
 }
@@ -937,6 +943,7 @@ inline Result mcopy(StackTop& stack, int64_t gas_left, ExecutionState& state) no
     if (const auto cost = copy_cost(size); (gas_left -= cost) < 0)
         return {EVMC_OUT_OF_GAS, gas_left};
 
+    state.memory.touch(dst, size);
     if (size > 0)
         std::memmove(&state.memory[dst], &state.memory[src], size);
 
@@ -994,6 +1001,7 @@ inline Result datacopy(StackTop& stack, int64_t gas_left, ExecutionState& state)
     if (const auto cost = copy_cost(s); (gas_left -= cost) < 0)
         return {EVMC_OUT_OF_GAS, gas_left};
 
+    state.memory.touch(dst, s);
     if (copy_size > 0)
         std::memcpy(&state.memory[dst], &state.data[src], copy_size);
 
@@ -116,7 +116,10 @@ Result call_impl(StackTop& stack, int64_t gas_left, ExecutionState& state) noexc
     stack.get_mut(0) = result.status_code == EVMC_SUCCESS;
 
     if (const auto copy_size = std::min(output_size, result.output_size); copy_size > 0)
+    {
+        state.memory.touch(output_offset, copy_size);
         std::memcpy(&state.memory[output_offset], result.output_data, copy_size);
+    }
 
     const auto gas_used = msg.gas - result.gas_left;
     gas_left -= gas_used;
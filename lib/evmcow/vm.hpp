@@ -25,9 +25,11 @@ class VM : public evmc_vm
 public:
     std::optional<std::unique_ptr<evmcow::ExecutionState>>  state{std::nullopt};
     std::vector<evmcow::Checkpoint>                         checkpoints{};
-    std::unique_ptr<evmcow::baseline::CodeAnalysis>         analysis{nullptr};
+    std::shared_ptr<const evmcow::baseline::CodeAnalysis>   analysis{nullptr};
     bool cgoto = EVMONE_CGOTO_SUPPORTED;
     bool validate_eof = false;
+    /// Run legacy code as threaded code instead of the opcode switch, unless tracing.
+    bool threaded = false;
 
     size_t op_count{0};
 
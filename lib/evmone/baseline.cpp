@@ -10,6 +10,15 @@
 #include "./vm.hpp"
 #include <memory>
 #include <optional>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <iostream>
 #include <glog/logging.h>
 #include <iomanip>
@@ -94,6 +103,172 @@ CodeAnalysis analyze(evmc_revision rev, bytes_view code)
     return analyze_eof1(code);
 }
 
+namespace
+{
+/// An analyzed code, keeping a copy of the code to tell hash collisions apart.
+struct CachedAnalysis
+{
+    evmc_revision rev;
+    std::vector<uint8_t> code;
+    std::shared_ptr<const CodeAnalysis> analysis;
+};
+
+/// A code registered by pin_code, matched by its address alone.
+struct PinnedCode
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    evmc_revision rev = EVMC_FRONTIER;
+    std::atomic<const CodeAnalysis*> analysis{nullptr};  ///< Owned by analysis_cache.
+};
+
+/// The lookup counters of one thread. Only the owner writes them, with plain stores.
+struct LookupCounters
+{
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> nanoseconds{0};
+    LookupCounters();
+    ~LookupCounters();
+};
+
+constexpr size_t max_pinned_codes = 64;
+
+std::shared_mutex analysis_cache_mu;
+std::unordered_multimap<size_t, CachedAnalysis> analysis_cache;
+std::array<PinnedCode, max_pinned_codes> pinned_codes;
+std::atomic<size_t> num_pinned_codes{0};
+std::atomic<size_t> analysis_misses{0};
+std::atomic<size_t> analysis_nanoseconds{0};
+
+std::mutex lookup_counters_mu;
+std::vector<LookupCounters*> lookup_counters;
+size_t retired_hits = 0;
+size_t retired_nanoseconds = 0;
+
+LookupCounters::LookupCounters()
+{
+    std::lock_guard lock{lookup_counters_mu};
+    lookup_counters.push_back(this);
+}
+
+LookupCounters::~LookupCounters()
+{
+    std::lock_guard lock{lookup_counters_mu};
+    retired_hits += hits.load(std::memory_order_relaxed);
+    retired_nanoseconds += nanoseconds.load(std::memory_order_relaxed);
+    std::erase(lookup_counters, this);
+}
+
+void bump(std::atomic<size_t>& counter, size_t n) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const CodeAnalysis> find_analysis(size_t hash, evmc_revision rev, bytes_view code)
+{
+    auto [first, last] = analysis_cache.equal_range(hash);
+    for (auto it = first; it != last; ++it)
+    {
+        const auto& entry = it->second;
+        if (entry.rev == rev && entry.code.size() == code.size() &&
+            std::memcmp(entry.code.data(), code.data(), code.size()) == 0)
+            return entry.analysis;
+    }
+    return nullptr;
+}
+
+PinnedCode* find_pinned(evmc_revision rev, bytes_view code) noexcept
+{
+    const auto num_pinned = num_pinned_codes.load(std::memory_order_acquire);
+    for (size_t i = 0; i < num_pinned; ++i)
+    {
+        auto& pin = pinned_codes[i];
+        if (pin.data == code.data() && pin.size == code.size() && pin.rev == rev)
+            return &pin;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const CodeAnalysis> lookup_analysis(
+    evmc_revision rev, bytes_view code, LookupCounters& counters)
+{
+    // pinned code never moves or changes, so its address is enough to find the analysis
+    auto* pin = find_pinned(rev, code);
+    if (pin != nullptr)
+    {
+        if (const auto* analysis = pin->analysis.load(std::memory_order_acquire))
+        {
+            bump(counters.hits, 1);
+            // cached analyses live as long as the process, a handle without ownership skips the
+            // reference count shared by all threads
+            return {std::shared_ptr<const CodeAnalysis>{}, analysis};
+        }
+    }
+    const auto hash = std::hash<std::string_view>{}(
+        std::string_view{reinterpret_cast<const char*>(code.data()), code.size()}) ^ rev;
+    auto analysis = [&] {
+        std::shared_lock lock{analysis_cache_mu};
+        return find_analysis(hash, rev, code);
+    }();
+    if (analysis != nullptr)
+        bump(counters.hits, 1);
+    else
+    {
+        // analyze without the lock, a racing thread analyzing the same code loses and shares ours
+        const auto start = std::chrono::steady_clock::now();
+        analysis = std::make_shared<const CodeAnalysis>(analyze(rev, code));
+        analysis_nanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+            std::memory_order_relaxed);
+        analysis_misses.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock lock{analysis_cache_mu};
+        if (auto cached = find_analysis(hash, rev, code))
+            analysis = cached;
+        else
+            analysis_cache.emplace(hash, CachedAnalysis{rev, {code.begin(), code.end()}, analysis});
+    }
+    if (pin != nullptr)
+        pin->analysis.store(analysis.get(), std::memory_order_release);
+    return analysis;
+}
+}  // namespace
+
+void pin_code(evmc_revision rev, bytes_view code)
+{
+    std::unique_lock lock{analysis_cache_mu};
+    const auto num_pinned = num_pinned_codes.load(std::memory_order_relaxed);
+    if (find_pinned(rev, code) != nullptr || num_pinned == max_pinned_codes)
+        return;
+    auto& pin = pinned_codes[num_pinned];
+    pin.data = code.data();
+    pin.size = code.size();
+    pin.rev = rev;
+    num_pinned_codes.store(num_pinned + 1, std::memory_order_release);
+}
+
+std::shared_ptr<const CodeAnalysis> analyze_shared(evmc_revision rev, bytes_view code)
+{
+    thread_local LookupCounters counters;
+    const auto start = std::chrono::steady_clock::now();
+    auto analysis = lookup_analysis(rev, code, counters);
+    bump(counters.nanoseconds,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    return analysis;
+}
+
+AnalysisStats analysis_stats() noexcept
+{
+    std::lock_guard lock{lookup_counters_mu};
+    auto hits = retired_hits;
+    auto nanoseconds = retired_nanoseconds;
+    for (const auto* counters : lookup_counters)
+    {
+        hits += counters->hits.load(std::memory_order_relaxed);
+        nanoseconds += counters->nanoseconds.load(std::memory_order_relaxed);
+    }
+    return {hits, analysis_misses.load(), nanoseconds, analysis_nanoseconds.load()};
+}
+
 /// Checks instruction requirements before execution.
 ///
 /// This checks:
@@ -353,7 +528,7 @@ evmc_result execute(VM& vm, const evmc_host_interface* host, evmc_host_context*
             return evmc_make_result(EVMC_CONTRACT_VALIDATION_FAILURE, 0, 0, nullptr, 0);
     }
     if (vm.analysis.get() == nullptr) {
-        vm.analysis = std::make_unique<CodeAnalysis>(analyze(rev, container));
+        vm.analysis = analyze_shared(rev, container);
     }
     const auto data = vm.analysis->eof_header.get_data(container);
     ExecutionState& state = *([&]{
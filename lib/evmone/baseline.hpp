@@ -52,6 +52,27 @@ static_assert(!std::is_copy_assignable_v<CodeAnalysis>);
 /// Analyze the code to build the bitmap of valid JUMPDEST locations.
 EVMC_EXPORT CodeAnalysis analyze(evmc_revision rev, bytes_view code);
 
+/// Analyze the code once per process. Later calls with the same code and revision share the analysis.
+/// Thread-safe.
+EVMC_EXPORT std::shared_ptr<const CodeAnalysis> analyze_shared(evmc_revision rev, bytes_view code);
+
+/// Promise that the code stays at its address, unchanged, until the process exits.
+/// analyze_shared then finds its analysis by address, without hashing, comparing or locking.
+/// Thread-safe.
+EVMC_EXPORT void pin_code(evmc_revision rev, bytes_view code);
+
+/// The counters of analyze_shared, which only runs analyze on a miss.
+struct AnalysisStats
+{
+    size_t hits;                 ///< Calls served from the cache.
+    size_t misses;               ///< Calls that ran analyze.
+    size_t nanoseconds;          ///< Time spent in analyze_shared, lookups included.
+    size_t analyze_nanoseconds;  ///< Time spent in analyze.
+};
+
+/// The counters of analyze_shared so far.
+EVMC_EXPORT AnalysisStats analysis_stats() noexcept;
+
 /// Executes in Baseline interpreter using EVMC-compatible parameters. (deprecated)
 evmc_result execute(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* ctx,
     evmc_revision rev, const evmc_message* msg, const uint8_t* code, size_t code_size) noexcept;
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <cstring>
 
 namespace evmone
 {
@@ -89,8 +90,9 @@ public:
         m_size = new_size;
     }
 
-    /// Virtually clears the memory by setting its size to 0. The capacity stays unchanged.
-    void clear() noexcept { m_size = 0; }
+    /// Clears the memory by setting its size to 0. The capacity stays unchanged, so the next grow
+    /// zero-fills without allocating.
+    void clear() noexcept { m_size = 0; m_data.clear(); }
 };
 
 /// The execution position.
@@ -100,6 +102,21 @@ struct Position
     uint256* stack_top;         ///< The pointer to the stack top.
 };
 
+/// Checkpoint of an execution state, whose live part is copied into an arena.
+///
+/// The arena holds, back to back: the stack items from the bottom up, the used memory,
+/// the return data and the call stack.
+struct Snapshot
+{
+    code_iterator code_it;      ///< The position in the code.
+    size_t stack_height;        ///< The number of stack items.
+    size_t memory_size;         ///< The memory size.
+    size_t return_data_size;    ///< The return data size.
+    size_t call_stack_size;     ///< The call stack depth.
+    int64_t gas_refund;         ///< The gas refund.
+    size_t arena_offset;        ///< Where the copied bytes start in the arena.
+};
+
 /// Generic execution state for generic instructions implementations.
 // NOLINTNEXTLINE(clang-analyzer-optin.performance.Padding)
 class ExecutionState
@@ -199,6 +216,62 @@ public:
         output_offset = 0;
         output_size = 0;
         m_tx = {};
+        will_break = false;
+        call_stack.clear();
+    }
+
+    /// Make a snapshot, appending only the live stack prefix and the used memory to an arena,
+    /// instead of copying the whole stack space.
+    Snapshot save_snapshot(std::vector<uint8_t>& arena) const
+    {
+        const auto stack_bottom = stack_space.bottom();
+        auto snapshot = Snapshot{
+            .code_it = position->code_it,
+            .stack_height = static_cast<size_t>(position->stack_top - stack_bottom),
+            .memory_size = memory.size(),
+            .return_data_size = return_data.size(),
+            .call_stack_size = call_stack.size(),
+            .gas_refund = gas_refund,
+            .arena_offset = arena.size(),
+        };
+        const auto append = [&](const void* data, size_t size) {
+            if (size == 0)
+                return;
+            const auto bytes = static_cast<const uint8_t*>(data);
+            arena.insert(arena.end(), bytes, bytes + size);
+        };
+        append(stack_bottom + 1, snapshot.stack_height * sizeof(uint256));
+        append(memory.data(), snapshot.memory_size);
+        append(return_data.data(), snapshot.return_data_size);
+        append(call_stack.data(), snapshot.call_stack_size * sizeof(const uint8_t*));
+        return snapshot;
+    }
+
+    /// Load a snapshot, releasing the arena space taken by it and by later snapshots.
+    void load_snapshot(const Snapshot& snapshot, std::vector<uint8_t>& arena) noexcept
+    {
+        const auto stack_bottom = stack_space.bottom();
+        auto bytes = arena.data() + snapshot.arena_offset;
+        if (snapshot.stack_height != 0)
+            std::memcpy(stack_bottom + 1, bytes, snapshot.stack_height * sizeof(uint256));
+        bytes += snapshot.stack_height * sizeof(uint256);
+        memory.clear();
+        if (snapshot.memory_size != 0)
+        {
+            memory.grow(snapshot.memory_size);
+            std::memcpy(&memory[0], bytes, snapshot.memory_size);
+        }
+        bytes += snapshot.memory_size;
+        return_data.assign(bytes, snapshot.return_data_size);
+        bytes += snapshot.return_data_size;
+        call_stack.resize(snapshot.call_stack_size);
+        if (snapshot.call_stack_size != 0)
+            std::memcpy(call_stack.data(), bytes, snapshot.call_stack_size * sizeof(const uint8_t*));
+        gas_refund = snapshot.gas_refund;
+        will_break = false;
+        status = EVMC_SUCCESS;
+        position = Position{snapshot.code_it, stack_bottom + snapshot.stack_height};
+        arena.resize(snapshot.arena_offset);
     }
 
     [[nodiscard]] bool in_static_mode() const { return (msg->flags & EVMC_STATIC) != 0; }
@@ -24,7 +24,9 @@ class VM : public evmc_vm
 public:
     std::optional<std::unique_ptr<evmone::ExecutionState>>  state{std::nullopt};
     std::vector<std::unique_ptr<evmone::ExecutionState>>    checkpoints{};
-    std::unique_ptr<evmone::baseline::CodeAnalysis>         analysis{nullptr};
+    std::vector<evmone::Snapshot>                           snapshots{};
+    std::vector<uint8_t>                                    arena{};
+    std::shared_ptr<const evmone::baseline::CodeAnalysis>   analysis{nullptr};
     bool cgoto = EVMONE_CGOTO_SUPPORTED;
     bool validate_eof = false;
     size_t op_count{0};
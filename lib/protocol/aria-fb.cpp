@@ -10,7 +10,7 @@
 namespace spectrum 
 {
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define T AriaTransaction
 
 using namespace std::chrono;
@@ -28,7 +28,7 @@ Aria::Aria(
     workload{workload},
     statistics{statistics},
     barrier(num_threads, []{ DLOG(INFO) << "batch complete" << std::endl; }),
-    table{table_partitions},
+    table{FLAGS_bucket_table, table_partitions, workload.CountKeys()},
     lock_table{table_partitions},
     enable_reordering{enable_reordering},
     num_threads{num_threads},
@@ -55,6 +55,11 @@ void Aria::Stop() {
     for (size_t i = 0; i < num_threads; ++i) {
         workers[i].join();
     }
+    statistics.JournalLocks(table.CountLocks() + lock_table.CountLocks());
+    statistics.JournalAccesses(
+        table.CountLocalAccesses() + lock_table.CountLocalAccesses(),
+        table.CountRemoteAccesses() + lock_table.CountRemoteAccesses()
+    );
     DLOG(INFO) << "aria stop";
 }
 
@@ -80,7 +85,7 @@ AriaTransaction::AriaTransaction(AriaTransaction&& tx):
 /// @param tx the transaction
 /// @param k the reserved key
 void AriaTable::ReserveGet(T* tx, const K& k) {
-    Table::Put(k, [&](AriaEntry& entry) {
+    SwitchTable::Update(k, [&](AriaEntry& entry) {
         DLOG(INFO) << tx->batch_id << ":" <<  tx->id << " reserve get, current tx(" << entry.batch_id_get << ":" << entry.reserved_get_tx << ")" << std::endl;
         if (entry.batch_id_get != tx->batch_id || entry.reserved_get_tx == nullptr || entry.reserved_get_tx->id > tx->id) {
             entry.reserved_get_tx = tx;
@@ -94,7 +99,7 @@ void AriaTable::ReserveGet(T* tx, const K& k) {
 /// @param tx the transaction
 /// @param k the reserved key
 void AriaTable::ReservePut(T* tx, const K& k) {
-    Table::Put(k, [&](AriaEntry& entry) {
+    SwitchTable::Update(k, [&](AriaEntry& entry) {
         DLOG(INFO) << tx->batch_id << ":" <<  tx->id << " reserve put, current tx(" << entry.batch_id_put << ":" << entry.reserved_put_tx << ")" << std::endl;
         if (entry.batch_id_put != tx->batch_id || entry.reserved_put_tx == nullptr || entry.reserved_put_tx->id > tx->id) {
             entry.reserved_put_tx = tx;
@@ -110,7 +115,7 @@ void AriaTable::ReservePut(T* tx, const K& k) {
 /// @return if current transaction reserved this entry successfully
 bool AriaTable::CompareReservedGet(T* tx, const K& k) {
     bool eq = true;
-    Table::Get(k, [&](auto entry) {
+    SwitchTable::Visit(k, [&](auto entry) {
         eq = entry.batch_id_get != tx->batch_id || (
             entry.reserved_get_tx == nullptr || 
             entry.reserved_get_tx->id == tx->id
@@ -125,7 +130,7 @@ bool AriaTable::CompareReservedGet(T* tx, const K& k) {
 /// @return if current transaction reserved this entry successfully
 bool AriaTable::CompareReservedPut(T* tx, const K& k) {
     bool eq = true;
-    Table::Get(k, [&](auto entry) {
+    SwitchTable::Visit(k, [&](auto entry) {
         eq = entry.batch_id_put != tx->batch_id || (
             entry.reserved_put_tx == nullptr || 
             entry.reserved_put_tx->id == tx->id
@@ -160,6 +165,7 @@ AriaExecutor::AriaExecutor(Aria& aria, size_t worker_id):
 
 /// @brief run transactions
 void AriaExecutor::Run() {
+    auto start_time = steady_clock::now();
     auto batch_id = size_t{0};
     auto batch = std::vector<T>();
     batch.reserve(repeat);
@@ -168,7 +174,10 @@ void AriaExecutor::Run() {
         // -- stage 1: generate and execute
         auto _stop = confirm_exit.load() == num_threads;
         barrier.arrive_and_wait();
-        if (_stop) { return; }
+        if (_stop) {
+            statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
+            return;
+        }
         if (stop_flag.load()) { confirm_exit.compare_exchange_weak(worker_id, worker_id + 1); }
         batch_id += 1;
         has_conflict.store(false);
@@ -231,7 +240,7 @@ void AriaExecutor::Execute(T* tx) {
         DLOG(INFO) << "tx " << tx->id << " get" << std::endl;
         // if some write on this entry is issued previously, 
         //  the read dependency will be barricated from journal. 
-        auto tup = std::make_tuple(addr, key);
+        auto tup = K(addr, key);
         if (tx->local_put.contains(tup)) {
             return tx->local_put[tup];
         }
@@ -239,7 +248,7 @@ void AriaExecutor::Execute(T* tx) {
             return tx->local_get[tup];
         }
         auto value = evmc::bytes32{0};
-        table.Get(tup, [&](auto& entry){
+        table.Visit(tup, [&](auto& entry){
             value = entry.value;
         });
         tx->local_get[tup] = value;
@@ -252,7 +261,7 @@ void AriaExecutor::Execute(T* tx) {
         const evmc::bytes32 &value
     ) {
         DLOG(INFO) << "tx " << tx->id << " set" << std::endl;
-        auto tup = std::make_tuple(addr, key);
+        auto tup = K(addr, key);
         tx->local_put[tup] = value;
         return evmc_storage_status::EVMC_STORAGE_MODIFIED;
     });
@@ -309,7 +318,7 @@ void AriaExecutor::Verify(T* tx) {
 /// @param tx the transaction
 void AriaExecutor::Commit(T* tx) {
     for (auto& tup: tx->local_put) {
-        table.Put(std::get<0>(tup), [&](auto& entry) {
+        table.Update(std::get<0>(tup), [&](auto& entry) {
             entry.value = std::get<1>(tup);
         });
     }
@@ -319,12 +328,12 @@ void AriaExecutor::Commit(T* tx) {
 /// @param tx the transaction
 void AriaExecutor::PrepareLockTable(T* tx) {
     for (auto& tup: tx->local_get) {
-        lock_table.Put(std::get<0>(tup), [&](auto& entry) {
+        lock_table.Update(std::get<0>(tup), [&](auto& entry) {
             entry.deps_get.push_back(tx);
         });
     }
     for (auto& tup: tx->local_put) {
-        lock_table.Put(std::get<0>(tup), [&](auto& entry) {
+        lock_table.Update(std::get<0>(tup), [&](auto& entry) {
             entry.deps_put.push_back(tx);
         });
     }
@@ -338,9 +347,9 @@ void AriaExecutor::Fallback(T* tx) {
         const evmc::address &addr,
         const evmc::bytes32 &key
     ) {
-        auto tup = std::make_tuple(addr, key);
+        auto tup = K(addr, key);
         auto value = evmc::bytes32{0};
-        table.Get(tup, [&](auto& entry){
+        table.Visit(tup, [&](auto& entry){
             value = entry.value;
         });
         return value;
@@ -351,8 +360,8 @@ void AriaExecutor::Fallback(T* tx) {
         const evmc::bytes32 &key,
         const evmc::bytes32 &value
     ) {
-        auto tup = std::make_tuple(addr, key);
-        table.Put(tup, [&](auto& entry){
+        auto tup = K(addr, key);
+        table.Update(tup, [&](auto& entry){
             entry.value = value;
         });
         return evmc_storage_status::EVMC_STORAGE_MODIFIED;
@@ -361,32 +370,37 @@ void AriaExecutor::Fallback(T* tx) {
     T* should_wait = nullptr;
     #define COND (_tx->id < tx->id && (should_wait == nullptr || _tx->id > should_wait->id))
     for (auto& tup: tx->local_put) {
-        lock_table.Get(std::get<0>(tup), [&](auto& entry) {
+        lock_table.Visit(std::get<0>(tup), [&](auto& entry) {
             for (auto _tx: entry.deps_get) { if (COND) { should_wait = _tx; } }
             for (auto _tx: entry.deps_put) { if (COND) { should_wait = _tx; } }
         });
     }
     for (auto& tup: tx->local_get) {
-        lock_table.Get(std::get<0>(tup), [&](auto& entry) {
+        lock_table.Visit(std::get<0>(tup), [&](auto& entry) {
             for (auto _tx: entry.deps_put) { if (COND) { should_wait = _tx; } }
         });
     }
     #undef COND
-    while(should_wait && !should_wait->committed.load()) {}
+    if (should_wait) {
+        auto wait_start = steady_clock::now();
+        WaitFor(should_wait->committed, true);
+        wait_time += steady_clock::now() - wait_start;
+    }
     tx->Execute();
     tx->committed.store(true);
+    tx->committed.notify_all();
 }
 
 /// @brief clean up the lock table
 /// @param tx the transaction to clean up
 void AriaExecutor::CleanLockTable(T* tx) {
     for (auto& tup: tx->local_put) {
-        lock_table.Put(std::get<0>(tup), [&](auto& entry) {
+        lock_table.Update(std::get<0>(tup), [&](auto& entry) {
             entry.deps_put.clear();
         });
     }
     for (auto& tup: tx->local_get) {
-        lock_table.Put(std::get<0>(tup), [&](auto& entry) {
+        lock_table.Update(std::get<0>(tup), [&](auto& entry) {
             entry.deps_get.clear();
         });
     }
@@ -12,12 +12,13 @@
 #include <atomic>
 #include <memory>
 #include <chrono>
+#include <spectrum/common/wait-util.hpp>
 #include <barrier>
 
 namespace spectrum
 {
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define T AriaTransaction
 
 /// @brief aria tranaction with local read and write set. 
@@ -43,7 +44,8 @@ struct AriaEntry {
 };
 
 /// @brief aria table for first round execution
-struct AriaTable: public Table<K, AriaEntry, KeyHasher> {
+struct AriaTable: public SwitchTable<K, AriaEntry, KeyHasher> {
+    using SwitchTable::SwitchTable;
     void ReserveGet(T* tx, const K& k);
     void ReservePut(T* tx, const K& k);
     bool CompareReservedGet(T* tx, const K& k);
@@ -104,6 +106,7 @@ class AriaExecutor {
     std::atomic<bool>&                      has_conflict;
     size_t                                  repeat;
     size_t                                  worker_id;
+    std::chrono::nanoseconds                wait_time{0};
 
     public:
     AriaExecutor(Aria& aria, size_t worker_id);
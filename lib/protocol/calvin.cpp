@@ -9,7 +9,7 @@
 namespace spectrum 
 {
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define T CalvinTransaction
 
 using namespace std::chrono;
@@ -26,7 +26,7 @@ Calvin::Calvin(
     workload{workload},
     statistics{statistics},
     barrier(num_threads, []{ DLOG(INFO) << "batch complete" << std::endl; }),
-    table{table_partitions},
+    table{FLAGS_bucket_table, table_partitions, workload.CountKeys()},
     lock_table{table_partitions},
     num_threads{num_threads},
     repeat{repeat}
@@ -52,6 +52,11 @@ void Calvin::Stop() {
     for (size_t i = 0; i < num_threads; ++i) {
         workers[i].join();
     }
+    statistics.JournalLocks(table.CountLocks() + lock_table.CountLocks());
+    statistics.JournalAccesses(
+        table.CountLocalAccesses() + lock_table.CountLocalAccesses(),
+        table.CountRemoteAccesses() + lock_table.CountRemoteAccesses()
+    );
     DLOG(INFO) << "calvin stop";
 }
 
@@ -95,6 +100,7 @@ CalvinExecutor::CalvinExecutor(Calvin& calvin, size_t worker_id):
 
 /// @brief run transactions
 void CalvinExecutor::Run() {
+    auto start_time = steady_clock::now();
     auto batch = std::vector<T>();
     batch.reserve(repeat);
     while(true) {
@@ -102,7 +108,10 @@ void CalvinExecutor::Run() {
         // -- stage 1: generate and predict
         auto _stop = confirm_exit.load() == num_threads;
         barrier.arrive_and_wait();
-        if (_stop) { return; }
+        if (_stop) {
+            statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
+            return;
+        }
         if (stop_flag.load()) {
             confirm_exit.compare_exchange_weak(worker_id, worker_id + 1);
         }
@@ -118,17 +127,26 @@ void CalvinExecutor::Run() {
         // -- stage 3: wait & execute each transaction
         barrier.arrive_and_wait();
         auto count_committed = 0;
-        while (count_committed != repeat) {for (auto& tx: batch) {
-            if (tx.committed.load()) { continue; }
-            if (tx.should_wait && !tx.should_wait->committed.load()) { continue; }
-            tx.Execute();
-            tx.committed.store(true);
-            statistics.JournalExecute();
-            statistics.JournalOperations(tx.CountOperations());
-            statistics.JournalCommit(LATENCY);
-            statistics.JournalMemory(tx.mm_count);
-            ++count_committed;
-        }}
+        auto backoff = Backoff();
+        while (count_committed != repeat) {
+            auto count_before = count_committed;
+            for (auto& tx: batch) {
+                if (tx.committed.load()) { continue; }
+                if (tx.should_wait && !tx.should_wait->committed.load()) { continue; }
+                tx.Execute();
+                tx.committed.store(true);
+                statistics.JournalExecute();
+                statistics.JournalOperations(tx.CountOperations());
+                statistics.JournalCommit(LATENCY);
+                statistics.JournalMemory(tx.mm_count);
+                ++count_committed;
+            }
+            if (count_committed != count_before) { backoff.Reset(); continue; }
+            // every remaining transaction waits on another worker, so back off before scanning again
+            auto wait_start = steady_clock::now();
+            if (!backoff.Pause()) { std::this_thread::yield(); }
+            wait_time += steady_clock::now() - wait_start;
+        }
         // -- stage 4: release lock
         barrier.arrive_and_wait();
         for (auto& tx: batch) {
@@ -142,12 +160,12 @@ void CalvinExecutor::Run() {
 /// @param tx the transaction
 void CalvinExecutor::PrepareLockTable(T* tx) {
     for (auto& key: tx->prediction.get) {
-        lock_table.Put(key, [&](auto& entry) {
+        lock_table.Update(key, [&](auto& entry) {
             entry.deps_get.push_back(tx);
         });
     }
     for (auto& key: tx->prediction.put) {
-        lock_table.Put(key, [&](auto& entry) {
+        lock_table.Update(key, [&](auto& entry) {
             entry.deps_put.push_back(tx);
         });
     }
@@ -161,9 +179,9 @@ void CalvinExecutor::Analyze(T* tx) {
         const evmc::address &addr,
         const evmc::bytes32 &key
     ) {
-        auto tup = std::make_tuple(addr, key);
+        auto tup = K(addr, key);
         auto value = evmc::bytes32{0};
-        table.Get(tup, [&](auto& entry){
+        table.Visit(tup, [&](auto& entry){
             value = entry.value;
         });
         return value;
@@ -174,8 +192,8 @@ void CalvinExecutor::Analyze(T* tx) {
         const evmc::bytes32 &key,
         const evmc::bytes32 &value
     ) {
-        auto tup = std::make_tuple(addr, key);
-        table.Put(tup, [&](auto& entry){
+        auto tup = K(addr, key);
+        table.Update(tup, [&](auto& entry){
             entry.value = value;
         });
         return evmc_storage_status::EVMC_STORAGE_MODIFIED;
@@ -183,13 +201,13 @@ void CalvinExecutor::Analyze(T* tx) {
     // get the latest dependency and wait on it
     #define COND (_tx->id < tx->id && (tx->should_wait == nullptr || _tx->id > tx->should_wait->id))
     for (auto& key: tx->prediction.put) {
-        lock_table.Get(key, [&](auto& entry) {
+        lock_table.Visit(key, [&](auto& entry) {
             for (auto _tx: entry.deps_get) { if (COND) { tx->should_wait = _tx; } }
             for (auto _tx: entry.deps_put) { if (COND) { tx->should_wait = _tx; } }
         });
     }
     for (auto& key: tx->prediction.get) {
-        lock_table.Get(key, [&](auto& entry) {
+        lock_table.Visit(key, [&](auto& entry) {
             for (auto _tx: entry.deps_put) { if (COND) { tx->should_wait = _tx; } }
         });
     }
@@ -200,12 +218,12 @@ void CalvinExecutor::Analyze(T* tx) {
 /// @param tx the transaction to clean up
 void CalvinExecutor::CleanLockTable(T* tx) {
     for (auto& key: tx->prediction.put) {
-        lock_table.Put(key, [&](auto& entry) {
+        lock_table.Update(key, [&](auto& entry) {
             entry.deps_put.clear();
         });
     }
     for (auto& key: tx->prediction.get) {
-        lock_table.Put(key, [&](auto& entry) {
+        lock_table.Update(key, [&](auto& entry) {
             entry.deps_get.clear();
         });
     }
@@ -12,12 +12,13 @@
 #include <atomic>
 #include <memory>
 #include <chrono>
+#include <spectrum/common/wait-util.hpp>
 #include <barrier>
 
 namespace spectrum
 {
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define T CalvinTransaction
 
 /// @brief calvin tranaction with local read and write set. 
@@ -38,7 +39,9 @@ struct CalvinEntry {
 };
 
 /// @brief calvin table for first round execution
-struct CalvinTable: public Table<K, CalvinEntry, KeyHasher> {};
+struct CalvinTable: public SwitchTable<K, CalvinEntry, KeyHasher> {
+    using SwitchTable::SwitchTable;
+};
 
 /// @brief calvin table entry for fallback pessimistic execution
 struct CalvinLockEntry {
@@ -92,6 +95,7 @@ class CalvinExecutor {
     std::atomic<bool>&                      has_conflict;
     size_t                                  repeat;
     size_t                                  worker_id;
+    std::chrono::nanoseconds                wait_time{0};
 
     public:
     CalvinExecutor(Calvin& calvin, size_t worker_id);
@@ -9,7 +9,7 @@ Dummy::Dummy(Workload& workload, Statistics& statistics, size_t num_threads, siz
     workload{workload},
     statistics{statistics},
     num_threads{num_threads},
-    table(table_partitions)
+    table(FLAGS_bucket_table, table_partitions, workload.CountKeys())
 {
     LOG(INFO) << fmt::format("Dummy(num_threads={}, table_partitions={})", num_threads, table_partitions) << std::endl;
     workload.SetEVMType(evm_type);
@@ -20,11 +20,11 @@ void Dummy::Start() {
         auto tx         = workload.Next();
         auto start_time = steady_clock::now();
         tx.InstallGetStorageHandler([&](auto& address, auto& key) {
-            evmc::bytes32 v; table.Get({address, key}, [&](auto& _v) { v = _v; });
+            evmc::bytes32 v; table.Visit({address, key}, [&](auto& _v) { v = _v; });
             return v;
         });
         tx.InstallSetStorageHandler([&](auto& address, auto& key, auto& v) {
-            table.Put({address, key}, [&](auto& _v) { _v = v; });
+            table.Update({address, key}, [&](auto& _v) { _v = v; });
             return evmc_storage_status::EVMC_STORAGE_MODIFIED;
         });
         tx.Execute();
@@ -38,6 +38,8 @@ void Dummy::Start() {
 void Dummy::Stop() {
     stop_flag.store(true);
     for (auto& x: executors) { x.join(); }
+    statistics.JournalLocks(table.CountLocks());
+    statistics.JournalAccesses(table.CountLocalAccesses(), table.CountRemoteAccesses());
 }
 
 } // namespace spectrum
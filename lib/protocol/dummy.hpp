@@ -9,9 +9,9 @@
 
 namespace spectrum {
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 
-using DummyTable = Table<K, evmc::bytes32, KeyHasher>;
+using DummyTable = SwitchTable<K, evmc::bytes32, KeyHasher>;
 
 class Dummy: public Protocol {
 
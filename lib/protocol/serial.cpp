@@ -55,11 +55,11 @@ void Serial::Stop() {
 }
 
 evmc::bytes32 SerialTable::GetStorage(const evmc::address& addr, const evmc::bytes32& key) {
-    return inner[std::make_tuple(addr, key)];
+    return inner[StorageKey(addr, key)];
 }
 
 void SerialTable::SetStorage(const evmc::address& addr, const evmc::bytes32& key, const evmc::bytes32& value) {
-    inner[std::make_tuple(addr, key)] = value;
+    inner[StorageKey(addr, key)] = value;
 }
 
 } // namespace spectrum
@@ -10,7 +10,7 @@ namespace spectrum {
 class SerialTable {
 
     private:
-    std::unordered_map<std::tuple<evmc::address, evmc::bytes32>, evmc::bytes32, KeyHasher> inner;
+    std::unordered_map<StorageKey, evmc::bytes32, KeyHasher> inner;
 
     public:
     evmc::bytes32 GetStorage(const evmc::address& addr, const evmc::bytes32& key);
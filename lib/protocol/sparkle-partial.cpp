@@ -7,14 +7,13 @@
 #include <thread>
 #include <chrono>
 #include <glog/logging.h>
-#include <ranges>
 #include <fmt/core.h>
 
 namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SparklePartialVersionList
 #define T SparklePartialTransaction
 
@@ -30,8 +29,7 @@ SparklePartialTransaction::SparklePartialTransaction(Transaction&& inner, size_t
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SparklePartialTransaction::HasWAR() {
-    auto guard = Guard{rerun_keys_mu};
-    return rerun_keys.size() != 0;
+    return war.load(std::memory_order_relaxed);
 }
 
 /// @brief call the transaction to rerun providing the key that caused it
@@ -39,7 +37,9 @@ bool SparklePartialTransaction::HasWAR() {
 void SparklePartialTransaction::SetWAR(const K& key, size_t cause_id) {
     auto guard = Guard{rerun_keys_mu};
     rerun_keys.push_back(key);
+    war.store(true, std::memory_order_relaxed);
     should_wait = std::max(should_wait, cause_id);
+    if (signal != nullptr) { signal->Notify(); }
 }
 
 /// @brief the multi-version table for spectrum
@@ -54,17 +54,14 @@ SparklePartialTable::SparklePartialTable(size_t partitions):
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SparklePartialTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -81,23 +78,19 @@ void SparklePartialTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& versi
 void SparklePartialTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto _tx: rit->readers) {
+            for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 if (_tx->id > tx->id) {
                     DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                     _tx->SetWAR(k, tx->id);
                 }
             }
-            break;
         }
         for (auto _tx: _v.readers_default) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
@@ -107,15 +100,15 @@ void SparklePartialTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
             }
         }
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value = v;
+        if (vit != end && vit->version == tx->id) {
+            vit->value = v;
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SparklePartialEntry {
+        _v.entries.Insert(SparklePartialEntry {
             .value   = v,
             .version = tx->id,
-            .readers = std::unordered_set<T*>()
+            .readers = ReaderSet<T>()
         });
     });
 }
@@ -125,15 +118,11 @@ void SparklePartialTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
 /// @param k the key of read entry
 void SparklePartialTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -161,22 +150,18 @@ void SparklePartialTable::RegretGet(T* tx, const K& k, size_t version) {
 /// @param k the key of this put entry
 void SparklePartialTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             // abort transactions that read from current transaction
             for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, tx->id);
             }
-            break;
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
@@ -186,16 +171,12 @@ void SparklePartialTable::RegretPut(T* tx, const K& k) {
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SparklePartialTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -223,10 +204,8 @@ void SparklePartialTable::ClearGet(T* tx, const K& k, size_t version) {
 /// @param k the key of written entry
 void SparklePartialTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -236,7 +215,7 @@ void SparklePartialTable::ClearPut(T* tx, const K& k) {
 /// @return true if lock succeeds
 bool SparklePartialTable::Lock(T* tx, const K& k) {
     bool succeed = false;
-    Table::Put(k, [&](V& _v) {
+    Table::Update(k, [&](V& _v) {
         DLOG(INFO) << "tx " << tx->id << " lock " << KeyHasher()(k) % 1000 << " see " << (_v.tx ? _v.tx->id : -1) << std::endl;
         if (_v.tx && _v.tx->id > tx->id) {
             _v.tx->SetWAR(k, tx->id);
@@ -254,7 +233,7 @@ bool SparklePartialTable::Lock(T* tx, const K& k) {
 bool SparklePartialTable::Unlock(T* tx, const K& k) {
     DLOG(INFO) << "tx " << tx->id << " unlock " << KeyHasher()(k) % 1000 << std::endl;
     bool succeed = false;
-    Table::Put(k, [&](V& _v) {
+    Table::Update(k, [&](V& _v) {
         if ((succeed = _v.tx == tx)) _v.tx = nullptr;
     });
     return succeed;
@@ -289,7 +268,10 @@ void SparklePartial::Start() {
 /// @brief stop spectrum protocol
 void SparklePartial::Stop() {
     stop_flag.store(true);
+    signal.Notify();
     for (auto& x: executors) 	{ x.join(); }
+    statistics.JournalLocks(table.CountLocks());
+    statistics.JournalAccesses(table.CountLocalAccesses(), table.CountRemoteAccesses());
 }
 
 /// @brief spectrum executor
@@ -298,6 +280,7 @@ SparklePartialExecutor::SparklePartialExecutor(SparklePartial& spectrum):
     table{spectrum.table},
     last_finalized{spectrum.last_finalized},
     stop_flag{spectrum.stop_flag},
+    signal{spectrum.signal},
     statistics{spectrum.statistics},
     workload{spectrum.workload},
     last_executed{spectrum.last_executed},
@@ -309,14 +292,16 @@ void SparklePartialExecutor::Generate() {
     if(tx != nullptr) return;
     tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
     tx->start_time = steady_clock::now();
+    tx->signal = &signal;
     tx->berun_flag.store(true);
     tx->InstallSetStorageHandler([this](
         const evmc::address &addr, 
         const evmc::bytes32 &key, 
         const evmc::bytes32 &value
     ) {
-        auto _key = std::make_tuple(addr, key);
+        auto _key = K(addr, key);
         table.Lock(tx.get(), _key);
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back({
             .key = _key, 
             .value = value, 
@@ -335,23 +320,22 @@ void SparklePartialExecutor::Generate() {
         const evmc::address &addr, 
         const evmc::bytes32 &key
     ) {
-        auto _key  = std::make_tuple(addr, key);
+        auto _key  = K(addr, key);
         auto value = evmc::bytes32{0};
         auto version = size_t{0};
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_put. ";
-            return tup.value;
+            return tx->tuples_put[i].value;
         }
-        for (auto& tup: tx->tuples_get) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindGet(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_get. ";
-            return tup.value;
+            return tx->tuples_get[i].value;
         }
         DLOG(INFO) << "tx " << tx->id << " " << 
             " read(" << tx->tuples_get.size() << ")" << 
             " key(" << KeyHasher()(_key) % 1000 << ")" << std::endl;
         table.Get(tx.get(), _key, value, version);
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back({
             .key            = _key, 
             .value          = value, 
@@ -393,14 +377,12 @@ void SparklePartialExecutor::ReExecute() {
     {
         auto guard = Guard{tx->rerun_keys_mu}; 
         std::swap(tx->rerun_keys, rerun_keys);
+        tx->war.store(false, std::memory_order_relaxed);
     }
     auto back_to = ~size_t{0};
     // find checkpoint
     for (auto& key: rerun_keys) {
-        for (size_t i = 0; i < tx->tuples_get.size(); ++i) {
-            if (tx->tuples_get[i].key != key) { continue; }
-            back_to = std::min(i, back_to); break;
-        }
+        back_to = std::min(tx->local_index.FindGet(key), back_to);
     }
     // good news: we don't have to rollback, so just resume execution
     if (back_to == ~size_t{0}) {
@@ -419,7 +401,9 @@ void SparklePartialExecutor::ReExecute() {
         table.RegretGet(tx.get(), tx->tuples_get[i].key, tx->tuples_get[i].version);
     }
     tx->tuples_put.resize(tup.tuples_put_len);
+    tx->local_index.TruncatePut(tup.tuples_put_len);
     tx->tuples_get.resize(back_to);
+    tx->local_index.TruncateGet(back_to);
     DLOG(INFO) << "tx " << tx->id <<
         " tuples put: " << tx->tuples_put.size() <<
         " tuples get: " << tx->tuples_get.size();
@@ -439,6 +423,7 @@ void SparklePartialExecutor::ReExecute() {
 void SparklePartialExecutor::Finalize() {
     DLOG(INFO) << "spectrum finalize " << tx->id;
     last_finalized.fetch_add(1, std::memory_order_seq_cst);
+    signal.Notify();
     for (auto entry: tx->tuples_get) {
         table.ClearGet(tx.get(), entry.key, entry.version);
     }
@@ -456,6 +441,7 @@ void SparklePartialExecutor::Finalize() {
 
 /// @brief start an executor
 void SparklePartialExecutor::Run() {
+    auto start_time = steady_clock::now();
     while (!stop_flag.load()) {
         // first generate a transaction
         Generate();
@@ -468,7 +454,14 @@ void SparklePartialExecutor::Run() {
             // then i can final commit and do another transaction. 
             Finalize();
         }
+        else {
+            // nothing to do until the previous transaction finalizes or this one has to re-execute
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{ return stop_flag.load() || last_finalized.load() + 1 == tx->id || tx->HasWAR(); });
+            wait_time += steady_clock::now() - wait_start;
+        }
     }
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
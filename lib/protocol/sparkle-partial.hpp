@@ -2,7 +2,10 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
-#include <list>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
+#include <spectrum/common/wait-util.hpp>
 #include <atomic>
 #include <tuple>
 #include <vector>
@@ -17,7 +20,7 @@
 namespace spectrum {
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SparklePartialVersionList
 #define T SparklePartialTransaction
 
@@ -42,10 +45,15 @@ struct SparklePartialTransaction: public Transaction {
     size_t      should_wait{0};
     SpinLock            rerun_keys_mu;
     std::vector<K>      rerun_keys;
+    // set together with rerun_keys under rerun_keys_mu, but read without it
+    std::atomic<bool>   war{false};
     std::atomic<bool>   berun_flag{false};
     time_point<steady_clock>            start_time;
+    // notified when this transaction has to re-execute
+    Signal*     signal{nullptr};
     std::vector<SparklePartialGetTuple>       tuples_get{};
     std::vector<SparklePartialPutTuple>       tuples_put{};
+    LocalIndex<K, KeyHasher>                  local_index;
     SparklePartialTransaction(Transaction&& inner, size_t id);
     bool HasWAR();
     void SetWAR(const K& key, size_t cause_id);
@@ -55,14 +63,16 @@ struct SparklePartialEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
 struct SparklePartialVersionList {
     T*          tx = nullptr;
-    std::list<SparklePartialEntry> entries;
+    VersionVector<SparklePartialEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    using allocator_type = VersionVector<SparklePartialEntry>::allocator_type;
+    SparklePartialVersionList(const allocator_type& alloc = {}): entries{alloc} {}
 };
 
 struct SparklePartialTable: private Table<K, V, KeyHasher> {
@@ -76,6 +86,9 @@ struct SparklePartialTable: private Table<K, V, KeyHasher> {
     void ClearPut(T* tx, const K& k);
     bool Lock(T* tx, const K& k);
     bool Unlock(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
@@ -92,6 +105,7 @@ class SparklePartial: public Protocol {
     std::atomic<size_t> last_executed{1};
     std::atomic<size_t> last_finalized{0};
     std::atomic<bool>   stop_flag{false};
+    Signal              signal;
     std::vector<std::thread>    executors{};
     std::barrier<std::function<void()>>            stop_latch;
     friend class SparklePartialExecutor;
@@ -112,8 +126,10 @@ class SparklePartialExecutor {
     std::atomic<size_t>&    last_executed;
     std::atomic<size_t>&    last_finalized;
     std::atomic<bool>&      stop_flag;
+    Signal&                 signal;
     SparklePartialQueue           queue;
     std::unique_ptr<T>      tx{nullptr};
+    nanoseconds             wait_time{0};
     std::barrier<std::function<void()>>&           stop_latch;
 
     public:
@@ -7,14 +7,13 @@
 #include <thread>
 #include <chrono>
 #include <glog/logging.h>
-#include <ranges>
 #include <fmt/core.h>
 
 namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SparklePreSchedVersionList
 #define T SparklePreSchedTransaction
 
@@ -30,8 +29,7 @@ SparklePreSchedTransaction::SparklePreSchedTransaction(Transaction&& inner, size
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SparklePreSchedTransaction::HasWAR() {
-    auto guard = Guard{rerun_keys_mu};
-    return rerun_keys.size() != 0;
+    return war.load(std::memory_order_relaxed);
 }
 
 /// @brief call the transaction to rerun providing the key that caused it
@@ -40,6 +38,7 @@ void SparklePreSchedTransaction::SetWAR(const K& key, size_t writer_id, bool pre
     if (!pre_schedule) {
         auto guard = Guard{rerun_keys_mu};
         rerun_keys.push_back(key);
+        war.store(true, std::memory_order_relaxed);
         return;
     }
     if (should_wait.contains(key)) {
@@ -67,16 +66,13 @@ SparklePreSchedLockTable::SparklePreSchedLockTable(size_t partitions):
 /// @param k the key of the read entry
 /// @param version (mutated to be) the version of read entry
 void SparklePreSchedLockTable::Get(T* tx, const K& k) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            rit->readers.insert(tx);
-            tx->SetWAR(k, rit->version, true);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            vit->readers.insert(tx);
+            tx->SetWAR(k, vit->version, true);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version 0" << std::endl;
@@ -90,44 +86,40 @@ void SparklePreSchedLockTable::Get(T* tx, const K& k) {
 void SparklePreSchedLockTable::Put(T* tx, const K& k) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        auto readers_ = std::unordered_set<T*>();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        auto readers_ = ReaderSet<T>();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto it = rit->readers.begin(); it != rit->readers.end();) {
-                DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << (*it) << ")" << std::endl;
-                if ((*it)->id <= tx->id) { ++it; continue; }
-                DLOG(INFO) << tx->id << " abort " << (*it)->id << std::endl;
-                (*it)->SetWAR(k, tx->id, true);
-                readers_.insert(*it);
-                it = rit->readers.erase(it);
-            }
-            break;
-        }
-        for (auto it = _v.readers_default.begin(); it != _v.readers_default.end();) {
-            DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << (*it) << ")" << std::endl;
-            if ((*it)->id <= tx->id) { ++it; continue; }
-            DLOG(INFO) << tx->id << " abort " << (*it)->id << std::endl;
-            (*it)->SetWAR(k, tx->id, true);
-            readers_.insert(*it);
-            it = _v.readers_default.erase(it);
+            vit->readers.EraseIf([&](T* _tx) {
+                DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
+                if (_tx->id <= tx->id) { return false; }
+                DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
+                _tx->SetWAR(k, tx->id, true);
+                readers_.insert(_tx);
+                return true;
+            });
         }
+        _v.readers_default.EraseIf([&](T* _tx) {
+            DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
+            if (_tx->id <= tx->id) { return false; }
+            DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
+            _tx->SetWAR(k, tx->id, true);
+            readers_.insert(_tx);
+            return true;
+        });
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
+        if (vit != end && vit->version == tx->id) {
             DCHECK(readers_.size() == 0);
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SparklePreSchedEntry {
+        _v.entries.Insert(SparklePreSchedEntry {
             .value   = evmc::bytes32{0},
             .version = tx->id,
-            .readers = readers_
+            .readers = std::move(readers_)
         });
     });
 }
@@ -137,10 +129,8 @@ void SparklePreSchedLockTable::Put(T* tx, const K& k) {
 /// @param k the key of written entry
 void SparklePreSchedLockTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -149,16 +139,12 @@ void SparklePreSchedLockTable::ClearPut(T* tx, const K& k) {
 /// @param k the key of read entry
 void SparklePreSchedLockTable::ClearGet(T* tx, const K& k) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version >= tx->id) {
-                ++rit; continue;
-            }
-            DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << rit->version << std::endl; 
-            rit->readers.erase(tx);
-            break;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id - 1);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
+            vit->readers.erase(tx);
         }
         _v.readers_default.erase(tx);
         // run an extra check in debug mode
@@ -191,17 +177,14 @@ SparklePreSchedTable::SparklePreSchedTable(size_t partitions):
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SparklePreSchedTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -218,23 +201,19 @@ void SparklePreSchedTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& vers
 void SparklePreSchedTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto _tx: rit->readers) {
+            for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 if (_tx->id > tx->id) {
                     DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                     _tx->SetWAR(k, tx->id, false);
                 }
             }
-            break;
         }
         for (auto _tx: _v.readers_default) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
@@ -244,15 +223,15 @@ void SparklePreSchedTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
             }
         }
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value = v;
+        if (vit != end && vit->version == tx->id) {
+            vit->value = v;
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SparklePreSchedEntry {
+        _v.entries.Insert(SparklePreSchedEntry {
             .value   = v,
             .version = tx->id,
-            .readers = std::unordered_set<T*>()
+            .readers = ReaderSet<T>()
         });
     });
 }
@@ -262,15 +241,11 @@ void SparklePreSchedTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
 /// @param k the key of read entry
 void SparklePreSchedTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -298,22 +273,18 @@ void SparklePreSchedTable::RegretGet(T* tx, const K& k, size_t version) {
 /// @param k the key of this put entry
 void SparklePreSchedTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             // abort transactions that read from current transaction
             for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, tx->id, false);
             }
-            break;
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
@@ -323,16 +294,12 @@ void SparklePreSchedTable::RegretPut(T* tx, const K& k) {
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SparklePreSchedTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -360,10 +327,8 @@ void SparklePreSchedTable::ClearGet(T* tx, const K& k, size_t version) {
 /// @param k the key of written entry
 void SparklePreSchedTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -373,7 +338,7 @@ void SparklePreSchedTable::ClearPut(T* tx, const K& k) {
 /// @return true if lock succeeds
 bool SparklePreSchedTable::Lock(T* tx, const K& k) {
     bool succeed = false;
-    Table::Put(k, [&](V& _v) {
+    Table::Update(k, [&](V& _v) {
         DLOG(INFO) << "tx " << tx->id << " lock " << KeyHasher()(k) % 1000 << " see " << (_v.tx ? _v.tx->id : -1) << std::endl;
         if (_v.tx && _v.tx->id > tx->id) {
             _v.tx->SetWAR(k, tx->id, false);
@@ -391,7 +356,7 @@ bool SparklePreSchedTable::Lock(T* tx, const K& k) {
 bool SparklePreSchedTable::Unlock(T* tx, const K& k) {
     DLOG(INFO) << "tx " << tx->id << " unlock " << KeyHasher()(k) % 1000 << std::endl;
     bool succeed = false;
-    Table::Put(k, [&](V& _v) {
+    Table::Update(k, [&](V& _v) {
         if ((succeed = _v.tx == tx)) _v.tx = nullptr;
     });
     return succeed;
@@ -427,7 +392,13 @@ void SparklePreSched::Start() {
 /// @brief stop spectrum protocol
 void SparklePreSched::Stop() {
     stop_flag.store(true);
+    signal.Notify();
     for (auto& x: executors) 	{ x.join(); }
+    statistics.JournalLocks(table.CountLocks() + lock_table.CountLocks());
+    statistics.JournalAccesses(
+        table.CountLocalAccesses() + lock_table.CountLocalAccesses(),
+        table.CountRemoteAccesses() + lock_table.CountRemoteAccesses()
+    );
 }
 
 /// @brief spectrum executor
@@ -439,25 +410,24 @@ SparklePreSchedExecutor::SparklePreSchedExecutor(SparklePreSched& spectrum):
     last_scheduled{spectrum.last_scheduled},
     last_committed{spectrum.last_committed},
     stop_flag{spectrum.stop_flag},
+    signal{spectrum.signal},
+    queue{spectrum.queue},
     statistics{spectrum.statistics},
     workload{spectrum.workload},
     last_executed{spectrum.last_executed},
     stop_latch{spectrum.stop_latch}
 {}
 
-/// @brief generate a transaction and execute it
-void SparklePreSchedExecutor::Execute() {
-    // if(tx != nullptr) return;
-    // tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
-    tx->start_time = steady_clock::now();
-    tx->berun_flag.store(true);
+/// @brief install storage handlers, bound to the executor currently running the transaction
+void SparklePreSchedExecutor::Install() {
     tx->InstallSetStorageHandler([this](
         const evmc::address &addr, 
         const evmc::bytes32 &key, 
         const evmc::bytes32 &value
     ) {
-        auto _key = std::make_tuple(addr, key);
+        auto _key = K(addr, key);
         table.Lock(tx.get(), _key);
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back({
             .key = _key, 
             .value = value, 
@@ -476,18 +446,16 @@ void SparklePreSchedExecutor::Execute() {
         const evmc::address &addr, 
         const evmc::bytes32 &key
     ) {
-        auto _key  = std::make_tuple(addr, key);
+        auto _key  = K(addr, key);
         auto value = evmc::bytes32{0};
         auto version = size_t{0};
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_put. ";
-            return tup.value;
+            return tx->tuples_put[i].value;
         }
-        for (auto& tup: tx->tuples_get) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindGet(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_get. ";
-            return tup.value;
+            return tx->tuples_get[i].value;
         }
         // we have to break after make checkpoint
         //   , or we will snapshot the break signal into the checkpoint!
@@ -496,13 +464,14 @@ void SparklePreSchedExecutor::Execute() {
             tx->Break();
         }
         // wait until the writer transcation to finalize
-        while (!stop_flag.load() && tx->ShouldWait(_key) > last_finalized.load()) {
-            continue;
-        }
+        auto wait_start = steady_clock::now();
+        signal.Wait([&]{ return stop_flag.load() || tx->ShouldWait(_key) <= last_finalized.load(); });
+        wait_time += steady_clock::now() - wait_start;
         DLOG(INFO) << "tx " << tx->id << " " << 
             " read(" << tx->tuples_get.size() << ")" << 
             " key(" << KeyHasher()(_key) % 1000 << ")" << std::endl;
         table.Get(tx.get(), _key, value, version);
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back({
             .key            = _key, 
             .value          = value, 
@@ -513,6 +482,15 @@ void SparklePreSchedExecutor::Execute() {
         
         return value;
     });
+}
+
+/// @brief generate a transaction and execute it
+void SparklePreSchedExecutor::Execute() {
+    // if(tx != nullptr) return;
+    // tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
+    tx->start_time = steady_clock::now();
+    tx->berun_flag.store(true);
+    Install();
     DLOG(INFO) << "spectrum execute " << tx->id;
     tx->Execute();
     statistics.JournalExecute();
@@ -539,14 +517,12 @@ void SparklePreSchedExecutor::ReExecute() {
     {
         auto guard = Guard{tx->rerun_keys_mu}; 
         std::swap(tx->rerun_keys, rerun_keys);
+        tx->war.store(false, std::memory_order_relaxed);
     }
     auto back_to = ~size_t{0};
     // find checkpoint
     for (auto& key: rerun_keys) {
-        for (size_t i = 0; i < tx->tuples_get.size(); ++i) {
-            if (tx->tuples_get[i].key != key) { continue; }
-            back_to = std::min(i, back_to); break;
-        }
+        back_to = std::min(tx->local_index.FindGet(key), back_to);
     }
     // good news: we don't have to rollback, so just resume execution
     if (back_to == ~size_t{0}) {
@@ -565,7 +541,9 @@ void SparklePreSchedExecutor::ReExecute() {
         table.RegretGet(tx.get(), tx->tuples_get[i].key, tx->tuples_get[i].version);
     }
     tx->tuples_put.resize(tup.tuples_put_len);
+    tx->local_index.TruncatePut(tup.tuples_put_len);
     tx->tuples_get.resize(back_to);
+    tx->local_index.TruncateGet(back_to);
     DLOG(INFO) << "tx " << tx->id <<
         " tuples put: " << tx->tuples_put.size() <<
         " tuples get: " << tx->tuples_get.size();
@@ -585,6 +563,7 @@ void SparklePreSchedExecutor::ReExecute() {
 void SparklePreSchedExecutor::Finalize() {
     DLOG(INFO) << "spectrum finalize " << tx->id;
     last_finalized.fetch_add(1, std::memory_order_seq_cst);
+    signal.Notify();
     for (auto entry: tx->tuples_get) {
         table.ClearGet(tx.get(), entry.key, entry.version);
     }
@@ -609,7 +588,7 @@ void SparklePreSchedExecutor::Finalize() {
 /// @brief schedule a transaction (put back to queue, swap a nullptr into it)
 void SparklePreSchedExecutor::Schedule() {
     // no available transaction, so we have to generate one!
-    if(queue.Size() != 0) { tx = queue.Pop(); return; }
+    if ((tx = queue.Pop()) != nullptr) { Install(); return; }
     tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
     tx->start_time = steady_clock::now();
     // prepare lock table, and gather lock information
@@ -620,12 +599,16 @@ void SparklePreSchedExecutor::Schedule() {
         lock_table.Put(tx.get(), k);
     }
     // wait lock table to stablize
-    while (!stop_flag.load() && last_scheduled.load() + 1 != tx->id) continue;
+    auto wait_start = steady_clock::now();
+    signal.Wait([&]{ return stop_flag.load() || last_scheduled.load() + 1 == tx->id; });
+    wait_time += steady_clock::now() - wait_start;
     last_scheduled.fetch_add(1);
+    signal.Notify();
 }
 
 /// @brief start an executor
 void SparklePreSchedExecutor::Run() {
+    auto start_time = steady_clock::now();
     while (!stop_flag.load()) {
         // find smallest workable transaction
         Schedule();
@@ -642,6 +625,7 @@ void SparklePreSchedExecutor::Run() {
             queue.Push(std::move(tx));
         }
     }
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
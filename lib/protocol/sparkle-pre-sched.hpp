@@ -2,7 +2,10 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
-#include <list>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
+#include <spectrum/common/wait-util.hpp>
 #include <atomic>
 #include <tuple>
 #include <vector>
@@ -13,7 +16,7 @@
 namespace spectrum {
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SparklePreSchedVersionList
 #define T SparklePreSchedTransaction
 
@@ -38,11 +41,14 @@ struct SparklePreSchedTransaction: public Transaction {
     // size_t      should_wait{0};
     SpinLock            rerun_keys_mu;
     std::vector<K>      rerun_keys;
+    // set together with rerun_keys under rerun_keys_mu, but read without it
+    std::atomic<bool>   war{false};
     std::atomic<bool>   berun_flag{false};
     time_point<steady_clock>            start_time;
     std::unordered_map<K, size_t, KeyHasher>    should_wait;
     std::vector<SparklePreSchedGetTuple>       tuples_get{};
     std::vector<SparklePreSchedPutTuple>       tuples_put{};
+    LocalIndex<K, KeyHasher>                   local_index;
     SparklePreSchedTransaction(Transaction&& inner, size_t id);
     bool HasWAR();
     size_t ShouldWait(const K& key);
@@ -53,14 +59,16 @@ struct SparklePreSchedEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
 struct SparklePreSchedVersionList {
     T*          tx = nullptr;
-    std::list<SparklePreSchedEntry> entries;
+    VersionVector<SparklePreSchedEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    using allocator_type = VersionVector<SparklePreSchedEntry>::allocator_type;
+    SparklePreSchedVersionList(const allocator_type& alloc = {}): entries{alloc} {}
 };
 
 struct SparklePreSchedLockTable: private Table<K, V, KeyHasher> {
@@ -69,6 +77,9 @@ struct SparklePreSchedLockTable: private Table<K, V, KeyHasher> {
     void Put(T* tx, const K& k);
     void ClearPut(T* tx, const K& k);
     void ClearGet(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
@@ -83,10 +94,13 @@ struct SparklePreSchedTable: private Table<K, V, KeyHasher> {
     void ClearPut(T* tx, const K& k);
     bool Lock(T* tx, const K& k);
     bool Unlock(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
-using SparklePreSchedQueue = LockPriorityQueue<T>;
+using SparklePreSchedQueue = RingPriorityQueue<T>;
 class SparklePreSchedExecutor;
 
 class SparklePreSched: public Protocol {
@@ -102,6 +116,9 @@ class SparklePreSched: public Protocol {
     std::atomic<size_t> last_scheduled{0};
     std::atomic<size_t> last_committed{0};
     std::atomic<bool>   stop_flag{false};
+    Signal              signal;
+    // transactions put back by any executor, picked up by the next idle one
+    SparklePreSchedQueue queue;
     std::vector<std::thread>    executors{};
     std::barrier<std::function<void()>>            stop_latch;
     friend class SparklePreSchedExecutor;
@@ -125,13 +142,16 @@ class SparklePreSchedExecutor {
     std::atomic<size_t>&        last_scheduled;
     std::atomic<size_t>&        last_committed;
     std::atomic<bool>&      stop_flag;
-    SparklePreSchedQueue           queue;
+    Signal&                 signal;
+    SparklePreSchedQueue&          queue;
     std::unique_ptr<T>      tx{nullptr};
+    nanoseconds             wait_time{0};
     std::barrier<std::function<void()>>&           stop_latch;
 
     public:
     SparklePreSchedExecutor(SparklePreSched& spectrum);
     void Finalize();
+    void Install();
     void Execute();
     void Schedule();
     void ReExecute();
@@ -7,7 +7,6 @@
 #include <chrono>
 #include <glog/logging.h>
 #include <fmt/core.h>
-#include <ranges>
 
 /*
     This is an implementation of "Sparkle: Speculative Deterministic Concurrency Control for Partially Replicated Transactional Data Stores" (Zhongmiao Li, Peter Van Roy and Paolo Romano). 
@@ -17,7 +16,7 @@ namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SparkleVersionList
 #define T SparkleTransaction
 
@@ -39,15 +38,14 @@ SparkleTable::SparkleTable(size_t partitions):
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SparkleTransaction::HasRerunFlag() {
-    auto guard = Guard{rerun_flag_mu};
-    return rerun_flag;
+    return rerun_flag.load(std::memory_order_relaxed);
 }
 
 /// @brief set rerun flag to true or false
 /// @param flag the value to assign to rerun_flag
 void SparkleTransaction::SetRerunFlag(bool flag) {
-    auto guard = Guard{rerun_flag_mu};
-    rerun_flag = flag;
+    rerun_flag.store(flag, std::memory_order_relaxed);
+    if (flag && signal != nullptr) { signal->Notify(); }
 }
 
 /// @brief get a value
@@ -56,17 +54,14 @@ void SparkleTransaction::SetRerunFlag(bool flag) {
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SparkleTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -82,23 +77,19 @@ void SparkleTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
 void SparkleTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << "commit " << tx->id;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto _tx: rit->readers) {
+            for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 if (_tx->id > tx->id) {
                     DLOG(INFO) << tx->id << " abort " << _tx->id;
                     _tx->SetRerunFlag(true);
                 }
             }
-            break;
         }
         for (auto _tx: _v.readers_default) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
@@ -108,15 +99,15 @@ void SparkleTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
             }
         }
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value = v;
+        if (vit != end && vit->version == tx->id) {
+            vit->value = v;
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SparkleEntry {
+        _v.entries.Insert(SparkleEntry {
             .value   = v,
             .version = tx->id,
-            .readers = std::unordered_set<T*>()
+            .readers = ReaderSet<T>()
         });
     });
 }
@@ -127,7 +118,7 @@ void SparkleTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
 /// @return true if lock succeeds
 bool SparkleTable::Lock(T* tx, const K& k) {
     bool succeed = false;
-    Table::Put(k, [&](V& _v) {
+    Table::Update(k, [&](V& _v) {
         DLOG(INFO) << "tx " << tx->id << " lock " << KeyHasher()(k) % 1000 << " see " << (_v.tx ? _v.tx->id : -1) << std::endl;
         if (_v.tx && _v.tx->id > tx->id) {
             _v.tx->SetRerunFlag(true);
@@ -145,7 +136,7 @@ bool SparkleTable::Lock(T* tx, const K& k) {
 bool SparkleTable::Unlock(T* tx, const K& k) {
     DLOG(INFO) << "tx " << tx->id << " unlock " << KeyHasher()(k) % 1000 << std::endl;
     bool succeed = false;
-    Table::Put(k, [&](V& _v) {
+    Table::Update(k, [&](V& _v) {
         if ((succeed = _v.tx == tx)) _v.tx = nullptr;
     });
     return succeed;
@@ -156,15 +147,11 @@ bool SparkleTable::Unlock(T* tx, const K& k) {
 /// @param k the key of read entry
 void SparkleTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -192,22 +179,18 @@ void SparkleTable::RegretGet(T* tx, const K& k, size_t version) {
 /// @param k the key of this put entry
 void SparkleTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "regret put " << tx->id << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             // abort transactions that read from current transaction
             for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetRerunFlag(true);
             }
-            break;
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
@@ -217,16 +200,12 @@ void SparkleTable::RegretPut(T* tx, const K& k) {
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SparkleTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "clear get " << tx->id << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -254,10 +233,8 @@ void SparkleTable::ClearGet(T* tx, const K& k, size_t version) {
 /// @param k the key of written entry
 void SparkleTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -269,6 +246,7 @@ Sparkle::Sparkle(Workload& workload, Statistics& statistics, size_t num_executor
     statistics{statistics},
     num_executors{num_executors},
     table{table_partitions},
+    throttle{statistics, signal, num_executors, milliseconds(FLAGS_throttle_ms)},
     stop_latch{static_cast<ptrdiff_t>(num_executors), []{}}
 {
     LOG(INFO) << fmt::format("Sparkle(num_executors={}, n_table_partitions={})", num_executors, table_partitions);
@@ -280,28 +258,37 @@ void Sparkle::Start() {
     stop_flag.store(false);
     for (size_t i = 0; i != num_executors; ++i) {
         DLOG(INFO) << "start executor " << i << std::endl;
-        executors.push_back(std::thread([this] {
-            std::make_unique<SparkleExecutor>(*this)->Run();
+        executors.push_back(std::thread([this, i] {
+            std::make_unique<SparkleExecutor>(*this, i)->Run();
         }));
         PinRoundRobin(executors[i], i);
     }
+    throttle.Start();
 }
 
 /// @brief stop sparkle protocol
 void Sparkle::Stop() {
+    throttle.Stop();
     stop_flag.store(true);
+    signal.Notify();
     for (size_t i = 0; i != num_executors; ++i) {
         executors[i].join();
     }
+    statistics.JournalLocks(table.CountLocks());
+    statistics.JournalAccesses(table.CountLocalAccesses(), table.CountRemoteAccesses());
 }
 
 /// @brief sparkle executor
 /// @param sparkle sparkle initialization paremeters
-SparkleExecutor::SparkleExecutor(Sparkle& sparkle):
+/// @param executor_id the index of this executor, which the throttle admits by
+SparkleExecutor::SparkleExecutor(Sparkle& sparkle, size_t executor_id):
     table{sparkle.table},
     last_finalized{sparkle.last_finalized},
     statistics{sparkle.statistics},
     stop_flag{sparkle.stop_flag},
+    signal{sparkle.signal},
+    throttle{sparkle.throttle},
+    executor_id{executor_id},
     workload{sparkle.workload},
     last_executed{sparkle.last_executed},
     stop_latch{sparkle.stop_latch}
@@ -312,14 +299,16 @@ void SparkleExecutor::Generate() {
     if(tx != nullptr) return;
     tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
     tx->start_time = steady_clock::now();
+    tx->signal = &signal;
     tx->InstallSetStorageHandler([this](
         const evmc::address &addr, 
         const evmc::bytes32 &key, 
         const evmc::bytes32 &value
     ) {
         DLOG(INFO) << tx->id << " set";
-        auto _key = std::make_tuple(addr, key);
+        auto _key = K(addr, key);
         table.Lock(tx.get(), _key);
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back(std::make_tuple(_key, value));
         if (tx->HasRerunFlag()) { tx->Break(); }
         return evmc_storage_status::EVMC_STORAGE_MODIFIED;
@@ -329,21 +318,18 @@ void SparkleExecutor::Generate() {
         const evmc::bytes32 &key
     ) {
         DLOG(INFO) << tx->id << " get";
-        auto _key   = std::make_tuple(addr, key);
+        auto _key   = K(addr, key);
         auto value  = evmc::bytes32{0};
         auto version = size_t{0};
         // one key from one transaction will be commited once
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (std::get<0>(tup) == _key) {
-                return std::get<1>(tup);
-            }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
+            return std::get<1>(tx->tuples_put[i]);
         }
-        for (auto& tup: tx->tuples_get) {
-            if (std::get<0>(tup) == _key) {
-                return std::get<1>(tup);
-            }
+        if (auto i = tx->local_index.FindGet(_key); i != tx->local_index.none) {
+            return std::get<1>(tx->tuples_get[i]);
         }
         table.Get(tx.get(), _key, value, version);
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back(std::make_tuple(_key, value, version));
         if (tx->HasRerunFlag()) { tx->Break(); }
         return value;
@@ -376,7 +362,9 @@ void SparkleExecutor::ReExecute() {
         table.Unlock(tx.get(), std::get<0>(entry));
     }
     tx->tuples_put.resize(0);
+    tx->local_index.TruncatePut(0);
     tx->tuples_get.resize(0);
+    tx->local_index.TruncateGet(0);
     tx->Execute();
     statistics.JournalExecute();
     statistics.JournalOperations(tx->CountOperations());
@@ -395,6 +383,7 @@ void SparkleExecutor::ReExecute() {
 void SparkleExecutor::Finalize() {
     DLOG(INFO) << "spectrum finalize " << tx->id;
     last_finalized.fetch_add(1, std::memory_order_seq_cst);
+    signal.Notify();
     for (auto entry: tx->tuples_get) {
         table.ClearGet(tx.get(), std::get<0>(entry), std::get<2>(entry));
     }
@@ -409,7 +398,15 @@ void SparkleExecutor::Finalize() {
 
 /// @brief start an executor
 void SparkleExecutor::Run() {
+    auto start_time = steady_clock::now();
     while (!stop_flag.load()) {
+        if (tx == nullptr && !throttle.Admit(executor_id)) {
+            // the throttle runs fewer executors for now, we hold nothing so we can sit out
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{ return stop_flag.load() || throttle.Admit(executor_id); });
+            wait_time += steady_clock::now() - wait_start;
+            continue;
+        }
         Generate();
         if (tx->HasRerunFlag()) {
             ReExecute();
@@ -417,7 +414,14 @@ void SparkleExecutor::Run() {
         else if (last_finalized.load() + 1 == tx->id && !tx->HasRerunFlag()) {
             Finalize();
         }
+        else {
+            // nothing to do until the previous transaction finalizes or this one has to re-execute
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{ return stop_flag.load() || last_finalized.load() + 1 == tx->id || tx->HasRerunFlag(); });
+            wait_time += steady_clock::now() - wait_start;
+        }
     }
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
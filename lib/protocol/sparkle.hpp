@@ -2,7 +2,11 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
-#include <list>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
+#include <spectrum/common/wait-util.hpp>
+#include <spectrum/common/throttle.hpp>
 #include <atomic>
 #include <tuple>
 #include <vector>
@@ -16,7 +20,7 @@ namespace spectrum {
 using namespace std::chrono;
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SparkleVersionList
 #define T SparkleTransaction
 
@@ -25,10 +29,12 @@ struct SparkleTransaction: public Transaction {
     size_t      execution_count{0};
     std::vector<std::tuple<K, evmc::bytes32, size_t>>   tuples_get{};
     std::vector<std::tuple<K, evmc::bytes32>>           tuples_put{};
-    SpinLock        rerun_flag_mu;
-    bool            rerun_flag{false};
+    LocalIndex<K, KeyHasher>                            local_index;
+    std::atomic<bool>   rerun_flag{false};
     bool            berun_flag{false};
     time_point<steady_clock>    start_time;
+    // notified when this transaction has to re-execute
+    Signal*     signal{nullptr};
     SparkleTransaction(Transaction&& inner, size_t id);
     bool HasRerunFlag();
     void SetRerunFlag(bool flag);
@@ -38,14 +44,16 @@ struct SparkleEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
 struct SparkleVersionList {
     T*          tx = nullptr;
-    std::list<SparkleEntry> entries;
+    VersionVector<SparkleEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    using allocator_type = VersionVector<SparkleEntry>::allocator_type;
+    SparkleVersionList(const allocator_type& alloc = {}): entries{alloc} {}
 };
 
 struct SparkleTable: private Table<K, V, KeyHasher> {
@@ -59,6 +67,9 @@ struct SparkleTable: private Table<K, V, KeyHasher> {
     void RegretPut(T* tx, const K& k);
     void ClearGet(T* tx, const K& k, size_t version);
     void ClearPut(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
@@ -75,6 +86,8 @@ class Sparkle: public Protocol {
     std::atomic<size_t> last_executed{1};
     std::atomic<size_t> last_finalized{0};
     std::atomic<bool>   stop_flag{false};
+    Signal              signal;
+    Throttle            throttle;
     std::vector<std::thread>    executors{};
     std::barrier<std::function<void()>>  stop_latch;
 
@@ -97,12 +110,16 @@ class SparkleExecutor {
     std::atomic<size_t>&    last_executed;
     std::atomic<size_t>&    last_finalized;
     std::atomic<bool>&      stop_flag;
+    Signal&                 signal;
+    Throttle&               throttle;
+    size_t                  executor_id;
     SparkleQueue            queue;
     std::unique_ptr<T>      tx{nullptr};
+    nanoseconds             wait_time{0};
     std::barrier<std::function<void()>>&           stop_latch;
 
     public:
-    SparkleExecutor(Sparkle& sparkle);
+    SparkleExecutor(Sparkle& sparkle, size_t executor_id);
     void Generate();
     void Finalize();
     void ReExecute();
@@ -6,7 +6,6 @@
 #include <thread>
 #include <chrono>
 #include <glog/logging.h>
-#include <ranges>
 #include <fmt/core.h>
 
 /*
@@ -18,7 +17,7 @@ namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumCacheVersionList
 #define T SpectrumCacheTransaction
 
@@ -34,8 +33,7 @@ SpectrumCacheTransaction::SpectrumCacheTransaction(Transaction&& inner, size_t i
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SpectrumCacheTransaction::HasWAR() {
-    auto guard = Guard{rerun_keys_mu};
-    return rerun_keys.size() != 0;
+    return war.load(std::memory_order_relaxed);
 }
 
 /// @brief call the transaction to rerun providing the key that caused it
@@ -43,6 +41,7 @@ bool SpectrumCacheTransaction::HasWAR() {
 void SpectrumCacheTransaction::SetWAR(const K& key, const evmc::bytes32* value, size_t version) {
     auto guard = Guard{rerun_keys_mu};
     rerun_keys.push_back(key);
+    war.store(true, std::memory_order_relaxed);
     should_wait = std::max(should_wait, version);
     if (value == nullptr) {
         for (auto it = local_cache[key].begin(); it != local_cache[key].end();) {
@@ -66,6 +65,7 @@ void SpectrumCacheTransaction::SetWAR(const K& key, const evmc::bytes32* value,
             }
         }
     }
+    if (signal != nullptr) { signal->Notify(); }
 }
 
 /// @brief the multi-version table for spectrum
@@ -80,17 +80,14 @@ SpectrumCacheTable::SpectrumCacheTable(size_t partitions):
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SpectrumCacheTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -106,43 +103,37 @@ void SpectrumCacheTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& versio
 void SpectrumCacheTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        auto readers_ = std::unordered_set<T*>();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        auto readers_ = ReaderSet<T>();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto tit = rit->readers.begin(); tit != rit->readers.end();) {
-                auto _tx = *tit;
+            vit->readers.EraseIf([&](T* _tx) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
-                if (_tx->id < tx->id) { ++tit; continue; }
+                if (_tx->id < tx->id) { return false; }
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, &v, tx->id);
                 readers_.insert(_tx);
-                tit = rit->readers.erase(tit);
-            }
-            break;
+                return true;
+            });
         }
-        for (auto tit = _v.readers_default.begin(); tit != _v.readers_default.end();) {
-            auto _tx = *tit;
+        _v.readers_default.EraseIf([&](T* _tx) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
-            if (_tx->id < tx->id) { ++tit; continue; }
+            if (_tx->id < tx->id) { return false; }
             DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
             _tx->SetWAR(k, &v, tx->id);
             readers_.insert(_tx);
-            tit = _v.readers_default.erase(tit);
-        }
+            return true;
+        });
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value   = v;
+        if (vit != end && vit->version == tx->id) {
+            vit->value   = v;
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SpectrumCacheEntry {
+        _v.entries.Insert(SpectrumCacheEntry {
             .value   = v,
             .version = tx->id,
             .readers = std::move(readers_)
@@ -155,15 +146,11 @@ void SpectrumCacheTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
 /// @param k the key of read entry
 void SpectrumCacheTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -191,31 +178,25 @@ void SpectrumCacheTable::RegretGet(T* tx, const K& k, size_t version) {
 /// @param k the key of this put entry
 void SpectrumCacheTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        auto last_value = evmc::bytes32{0};
-        auto readers_ = &_v.readers_default;
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                readers_ = &vit->readers;
-                last_value = vit->value;
-                ++vit; continue;
-            }
+        if (vit != end) {
+            // readers fall back to the preceding version
+            auto last_value = vit != _v.entries.begin() ? (vit - 1)->value : evmc::bytes32{0};
+            auto readers_ = vit != _v.entries.begin() ? &(vit - 1)->readers : &_v.readers_default;
             // abort transactions that read from current transaction
-            for (auto tit = vit->readers.begin(); tit != vit->readers.end();) {
-                auto _tx = *tit;
+            vit->readers.EraseIf([&](T* _tx) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
-                if (_tx->id < tx->id) { ++tit; continue; }
+                if (_tx->id < tx->id) { return false; }
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, nullptr, tx->id);
                 readers_->insert(_tx);
                 _tx->SetWAR(k, &last_value, tx->id);
-                tit = vit->readers.erase(tit);
-            }
-            break;
+                return true;
+            });
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
@@ -225,16 +206,12 @@ void SpectrumCacheTable::RegretPut(T* tx, const K& k) {
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SpectrumCacheTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -262,10 +239,8 @@ void SpectrumCacheTable::ClearGet(T* tx, const K& k, size_t version) {
 /// @param k the key of written entry
 void SpectrumCacheTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -298,7 +273,10 @@ void SpectrumCache::Start() {
 /// @brief stop spectrum protocol
 void SpectrumCache::Stop() {
     stop_flag.store(true);
+    signal.Notify();
     for (auto& x: executors) 	{ x.join(); }
+    statistics.JournalLocks(table.CountLocks());
+    statistics.JournalAccesses(table.CountLocalAccesses(), table.CountRemoteAccesses());
 }
 
 /// @brief spectrum executor
@@ -307,6 +285,7 @@ SpectrumCacheExecutor::SpectrumCacheExecutor(SpectrumCache& spectrum):
     table{spectrum.table},
     last_finalized{spectrum.last_finalized},
     stop_flag{spectrum.stop_flag},
+    signal{spectrum.signal},
     statistics{spectrum.statistics},
     workload{spectrum.workload},
     last_executed{spectrum.last_executed},
@@ -317,6 +296,7 @@ SpectrumCacheExecutor::SpectrumCacheExecutor(SpectrumCache& spectrum):
 void SpectrumCacheExecutor::Generate() {
     tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
     tx->start_time = steady_clock::now();
+    tx->signal = &signal;
     tx->berun_flag.store(true);
     tx->InstallSetStorageHandler([this](
         const evmc::address &addr, 
@@ -324,7 +304,8 @@ void SpectrumCacheExecutor::Generate() {
         const evmc::bytes32 &value
     ) {
         if (tx->HasWAR()) { tx->Break(); }
-        auto _key = std::make_tuple(addr, key);
+        auto _key = K(addr, key);
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back({
             .key = _key, 
             .value = value, 
@@ -337,11 +318,11 @@ void SpectrumCacheExecutor::Generate() {
         const evmc::bytes32 &key
     ) {
         if (tx->HasWAR()) { tx->Break(); return evmc::bytes32{0}; }
-        auto _key  = std::make_tuple(addr, key);
+        auto _key  = K(addr, key);
         auto value = evmc::bytes32{0};
         auto version = size_t{0};
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (tup.key == _key) { return tup.value; }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
+            return tx->tuples_put[i].value;
         }
         {
             // return cached value if there is any
@@ -352,6 +333,7 @@ void SpectrumCacheExecutor::Generate() {
         }
         table.Get(tx.get(), _key, value, version);
         size_t checkpoint_id = tx->MakeCheckpoint();
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back({
             .key            = _key, 
             .value          = value, 
@@ -401,14 +383,12 @@ void SpectrumCacheExecutor::ReExecute() {
     {
         auto guard = Guard{tx->rerun_keys_mu}; 
         std::swap(tx->rerun_keys, rerun_keys);
+        tx->war.store(false, std::memory_order_relaxed);
     }
     auto back_to = ~size_t{0};
     // find checkpoint
     for (auto& key: rerun_keys) {
-        for (size_t i = 0; i < tx->tuples_get.size(); ++i) {
-            if (tx->tuples_get[i].key != key) { continue; }
-            back_to = std::min(i, back_to); break;
-        }
+        back_to = std::min(tx->local_index.FindGet(key), back_to);
     }
     // good news: we don't have to rollback
     if (back_to == ~size_t{0}) { return; }
@@ -422,7 +402,9 @@ void SpectrumCacheExecutor::ReExecute() {
     }
     // leave out the reader entries, so that they can receive updates
     tx->tuples_put.resize(tup.tuples_put_len);
+    tx->local_index.TruncatePut(tup.tuples_put_len);
     tx->tuples_get.resize(back_to);
+    tx->local_index.TruncateGet(back_to);
     tx->Execute();
     statistics.JournalExecute();
     statistics.JournalOperations(tx->CountOperations());
@@ -439,6 +421,7 @@ void SpectrumCacheExecutor::ReExecute() {
 void SpectrumCacheExecutor::Finalize() {
     DLOG(INFO) << "spectrum finalize " << tx->id;
     last_finalized.fetch_add(1, std::memory_order_seq_cst);
+    signal.Notify();
     for (auto entry: tx->local_cache) {
         if (entry.second.size()) {
             table.ClearGet(tx.get(), entry.first, entry.second.back().version);
@@ -454,6 +437,7 @@ void SpectrumCacheExecutor::Finalize() {
 
 /// @brief start an executor
 void SpectrumCacheExecutor::Run() {
+    auto start_time = steady_clock::now();
     // first generate a transaction
     Generate();
     while (!stop_flag.load()) {
@@ -467,7 +451,14 @@ void SpectrumCacheExecutor::Run() {
             Finalize();
             Generate();
         }
+        else {
+            // nothing to do until the previous transaction finalizes or this one has to re-execute
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{ return stop_flag.load() || last_finalized.load() + 1 == tx->id || tx->HasWAR(); });
+            wait_time += steady_clock::now() - wait_start;
+        }
     }
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
@@ -2,6 +2,10 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
+#include <spectrum/common/wait-util.hpp>
 #include <list>
 #include <atomic>
 #include <tuple>
@@ -15,7 +19,7 @@
 namespace spectrum {
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumCacheVersionList
 #define T SpectrumCacheTransaction
 
@@ -45,10 +49,15 @@ struct SpectrumCacheTransaction: public Transaction {
     size_t      should_wait{0};
     SpinLock            rerun_keys_mu;
     std::vector<K>      rerun_keys;
+    // set together with rerun_keys under rerun_keys_mu, but read without it
+    std::atomic<bool>   war{false};
     std::atomic<bool>   berun_flag{false};
     time_point<steady_clock>                        start_time;
+    // notified when this transaction has to re-execute
+    Signal*     signal{nullptr};
     std::vector<SpectrumCacheGetTuple>              tuples_get{};
     std::vector<SpectrumCachePutTuple>              tuples_put{};
+    LocalIndex<K, KeyHasher>                        local_index;
     std::unordered_map<K, std::list<CacheTuple>, KeyHasher>    local_cache;
     SpectrumCacheTransaction(Transaction&& inner, size_t id);
     bool HasWAR();
@@ -59,14 +68,16 @@ struct SpectrumCacheEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
 struct SpectrumCacheVersionList {
     T*          tx = nullptr;
-    std::list<SpectrumCacheEntry> entries;
+    VersionVector<SpectrumCacheEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    using allocator_type = VersionVector<SpectrumCacheEntry>::allocator_type;
+    SpectrumCacheVersionList(const allocator_type& alloc = {}): entries{alloc} {}
 };
 
 struct SpectrumCacheTable: private Table<K, V, KeyHasher> {
@@ -78,6 +89,9 @@ struct SpectrumCacheTable: private Table<K, V, KeyHasher> {
     void RegretPut(T* tx, const K& k);
     void ClearGet(T* tx, const K& k, size_t version);
     void ClearPut(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
@@ -94,6 +108,7 @@ class SpectrumCache: public Protocol {
     std::atomic<size_t> last_executed{1};
     std::atomic<size_t> last_finalized{0};
     std::atomic<bool>   stop_flag{false};
+    Signal              signal;
     std::vector<std::thread>                executors{};
     std::barrier<std::function<void()>>     stop_latch;
     friend class SpectrumCacheExecutor;
@@ -114,7 +129,9 @@ class SpectrumCacheExecutor {
     std::atomic<size_t>&    last_executed;
     std::atomic<size_t>&    last_finalized;
     std::atomic<bool>&      stop_flag;
+    Signal&                 signal;
     std::unique_ptr<T>      tx{nullptr};
+    nanoseconds             wait_time{0};
     std::barrier<std::function<void()>>&           stop_latch;
 
     public:
@@ -7,7 +7,6 @@
 #include <thread>
 #include <chrono>
 #include <glog/logging.h>
-#include <ranges>
 #include <fmt/core.h>
 #include <iostream>
 
@@ -20,7 +19,7 @@ namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumNoPartialPreSchedVersionList
 #define T SpectrumNoPartialPreSchedTransaction
 
@@ -36,8 +35,7 @@ SpectrumNoPartialPreSchedTransaction::SpectrumNoPartialPreSchedTransaction(Trans
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SpectrumNoPartialPreSchedTransaction::HasWAR() {
-    auto guard = Guard{rerun_keys_mu};
-    return rerun_keys.size() != 0;
+    return war.load(std::memory_order_relaxed);
 }
 
 /// @brief call the transaction to rerun providing the key that caused it
@@ -46,6 +44,7 @@ void SpectrumNoPartialPreSchedTransaction::SetWAR(const K& key, size_t writer_id
     if (!pre_schedule) {
         auto guard = Guard{rerun_keys_mu};
         rerun_keys.push_back(key);
+        war.store(true, std::memory_order_relaxed);
         return;
     }
     if (should_wait.contains(key)) {
@@ -72,16 +71,13 @@ SpectrumNoPartialPreSchedLockTable::SpectrumNoPartialPreSchedLockTable(size_t pa
 /// @param k the key of the read entry
 /// @param version (mutated to be) the version of read entry
 void SpectrumNoPartialPreSchedLockTable::Get(T* tx, const K& k) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            rit->readers.insert(tx);
-            tx->SetWAR(k, rit->version, true);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            vit->readers.insert(tx);
+            tx->SetWAR(k, vit->version, true);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version 0" << std::endl;
@@ -95,44 +91,40 @@ void SpectrumNoPartialPreSchedLockTable::Get(T* tx, const K& k) {
 void SpectrumNoPartialPreSchedLockTable::Put(T* tx, const K& k) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        auto readers_ = std::unordered_set<T*>();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        auto readers_ = ReaderSet<T>();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto it = rit->readers.begin(); it != rit->readers.end();) {
-                DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << (*it) << ")" << std::endl;
-                if ((*it)->id <= tx->id) { ++it; continue; }
-                DLOG(INFO) << tx->id << " abort " << (*it)->id << std::endl;
-                (*it)->SetWAR(k, tx->id, true);
-                readers_.insert(*it);
-                it = rit->readers.erase(it);
-            }
-            break;
-        }
-        for (auto it = _v.readers_default.begin(); it != _v.readers_default.end();) {
-            DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << (*it) << ")" << std::endl;
-            if ((*it)->id <= tx->id) { ++it; continue; }
-            DLOG(INFO) << tx->id << " abort " << (*it)->id << std::endl;
-            (*it)->SetWAR(k, tx->id, true);
-            readers_.insert(*it);
-            it = _v.readers_default.erase(it);
+            vit->readers.EraseIf([&](T* _tx) {
+                DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
+                if (_tx->id <= tx->id) { return false; }
+                DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
+                _tx->SetWAR(k, tx->id, true);
+                readers_.insert(_tx);
+                return true;
+            });
         }
+        _v.readers_default.EraseIf([&](T* _tx) {
+            DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
+            if (_tx->id <= tx->id) { return false; }
+            DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
+            _tx->SetWAR(k, tx->id, true);
+            readers_.insert(_tx);
+            return true;
+        });
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
+        if (vit != end && vit->version == tx->id) {
             DCHECK(readers_.size() == 0);
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SpectrumNoPartialPreSchedEntry {
+        _v.entries.Insert(SpectrumNoPartialPreSchedEntry {
             .value   = evmc::bytes32{0},
             .version = tx->id,
-            .readers = readers_
+            .readers = std::move(readers_)
         });
     });
 }
@@ -142,10 +134,8 @@ void SpectrumNoPartialPreSchedLockTable::Put(T* tx, const K& k) {
 /// @param k the key of written entry
 void SpectrumNoPartialPreSchedLockTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -154,16 +144,12 @@ void SpectrumNoPartialPreSchedLockTable::ClearPut(T* tx, const K& k) {
 /// @param k the key of read entry
 void SpectrumNoPartialPreSchedLockTable::ClearGet(T* tx, const K& k) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version >= tx->id) {
-                ++rit; continue;
-            }
-            DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << rit->version << std::endl; 
-            rit->readers.erase(tx);
-            break;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id - 1);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
+            vit->readers.erase(tx);
         }
         _v.readers_default.erase(tx);
         // run an extra check in debug mode
@@ -196,17 +182,14 @@ SpectrumNoPartialPreSchedTable::SpectrumNoPartialPreSchedTable(size_t partitions
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SpectrumNoPartialPreSchedTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -223,23 +206,19 @@ void SpectrumNoPartialPreSchedTable::Get(T* tx, const K& k, evmc::bytes32& v, si
 void SpectrumNoPartialPreSchedTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto _tx: rit->readers) {
+            for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 if (_tx->id > tx->id) {
                     DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                     _tx->SetWAR(k, tx->id, false);
                 }
             }
-            break;
         }
         for (auto _tx: _v.readers_default) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
@@ -249,15 +228,15 @@ void SpectrumNoPartialPreSchedTable::Put(T* tx, const K& k, const evmc::bytes32&
             }
         }
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value = v;
+        if (vit != end && vit->version == tx->id) {
+            vit->value = v;
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SpectrumNoPartialPreSchedEntry {
+        _v.entries.Insert(SpectrumNoPartialPreSchedEntry {
             .value   = v,
             .version = tx->id,
-            .readers = std::unordered_set<T*>()
+            .readers = ReaderSet<T>()
         });
     });
 }
@@ -267,15 +246,11 @@ void SpectrumNoPartialPreSchedTable::Put(T* tx, const K& k, const evmc::bytes32&
 /// @param k the key of read entry
 void SpectrumNoPartialPreSchedTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -303,22 +278,18 @@ void SpectrumNoPartialPreSchedTable::RegretGet(T* tx, const K& k, size_t version
 /// @param k the key of this put entry
 void SpectrumNoPartialPreSchedTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             // abort transactions that read from current transaction
             for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, tx->id, false);
             }
-            break;
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
@@ -328,16 +299,12 @@ void SpectrumNoPartialPreSchedTable::RegretPut(T* tx, const K& k) {
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SpectrumNoPartialPreSchedTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -365,10 +332,8 @@ void SpectrumNoPartialPreSchedTable::ClearGet(T* tx, const K& k, size_t version)
 /// @param k the key of written entry
 void SpectrumNoPartialPreSchedTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -402,7 +367,13 @@ void SpectrumNoPartialPreSched::Start() {
 /// @brief stop spectrum protocol
 void SpectrumNoPartialPreSched::Stop() {
     stop_flag.store(true);
+    signal.Notify();
     for (auto& x: executors) 	{ x.join(); }
+    statistics.JournalLocks(table.CountLocks() + lock_table.CountLocks());
+    statistics.JournalAccesses(
+        table.CountLocalAccesses() + lock_table.CountLocalAccesses(),
+        table.CountRemoteAccesses() + lock_table.CountRemoteAccesses()
+    );
 }
 
 /// @brief spectrum executor
@@ -414,15 +385,16 @@ SpectrumNoPartialPreSchedExecutor::SpectrumNoPartialPreSchedExecutor(SpectrumNoP
     last_scheduled{spectrum.last_scheduled},
     last_committed{spectrum.last_committed},
     stop_flag{spectrum.stop_flag},
+    signal{spectrum.signal},
+    queue{spectrum.queue},
     statistics{spectrum.statistics},
     workload{spectrum.workload},
     last_executed{spectrum.last_executed},
     stop_latch{spectrum.stop_latch}
 {}
 
-/// @brief generate a transaction and execute it
-void SpectrumNoPartialPreSchedExecutor::Execute() {
-    tx->berun_flag.store(true);
+/// @brief install storage handlers, bound to the executor currently running the transaction
+void SpectrumNoPartialPreSchedExecutor::Install() {
     auto tx_ref = tx.get();
     tx->InstallSetStorageHandler([tx_ref](
         const evmc::address &addr, 
@@ -430,7 +402,8 @@ void SpectrumNoPartialPreSchedExecutor::Execute() {
         const evmc::bytes32 &value
     ) {
         auto tx = tx_ref;
-        auto _key   = std::make_tuple(addr, key);
+        auto _key   = K(addr, key);
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back({
             .key = _key, 
             .value = value, 
@@ -444,22 +417,23 @@ void SpectrumNoPartialPreSchedExecutor::Execute() {
         const evmc::bytes32 &key
     ) {
         auto tx = tx_ref;
-        auto _key   = std::make_tuple(addr, key);
+        auto _key   = K(addr, key);
         auto value  = evmc::bytes32{0};
         auto version = size_t{0};
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (tup.key == _key) { return tup.value; }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
+            return tx->tuples_put[i].value;
         }
-        for (auto& tup: tx->tuples_get) {
-            if (tup.key == _key) { return tup.value; }
+        if (auto i = tx->local_index.FindGet(_key); i != tx->local_index.none) {
+            return tx->tuples_get[i].value;
         }
         if (tx->HasWAR()) { tx->Break(); }
         // wait until the writer transcation to finalize
-        while (!stop_flag.load() && tx->ShouldWait(_key) > last_finalized.load()) {
-            continue;
-        }
+        auto wait_start = steady_clock::now();
+        signal.Wait([&]{ return stop_flag.load() || tx->ShouldWait(_key) <= last_finalized.load(); });
+        wait_time += steady_clock::now() - wait_start;
         table.Get(tx, _key, value, version);
         size_t checkpoint_id = tx->MakeCheckpoint();
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back({
             .key            = _key, 
             .value          = value, 
@@ -469,6 +443,12 @@ void SpectrumNoPartialPreSchedExecutor::Execute() {
         });
         return value;
     });
+}
+
+/// @brief generate a transaction and execute it
+void SpectrumNoPartialPreSchedExecutor::Execute() {
+    tx->berun_flag.store(true);
+    Install();
     DLOG(INFO) << "spectrum execute " << tx->id;
     tx->Execute();
     statistics.JournalExecute();
@@ -487,7 +467,11 @@ void SpectrumNoPartialPreSchedExecutor::Execute() {
 
 void SpectrumNoPartialPreSchedExecutor::ReExecute() {
     DLOG(INFO) << "spectrum-no-partial re-execute " << tx->id;
-    tx->rerun_keys.clear();
+    {
+        auto guard = Guard{tx->rerun_keys_mu};
+        tx->rerun_keys.clear();
+        tx->war.store(false, std::memory_order_relaxed);
+    }
     tx->ApplyCheckpoint(0);
     for (auto entry: tx->tuples_get) {
         table.RegretGet(tx.get(), entry.key, entry.version);
@@ -496,7 +480,9 @@ void SpectrumNoPartialPreSchedExecutor::ReExecute() {
         table.RegretPut(tx.get(), entry.key);
     }
     tx->tuples_put.resize(0);
+    tx->local_index.TruncatePut(0);
     tx->tuples_get.resize(0);
+    tx->local_index.TruncateGet(0);
     tx->Execute();
     statistics.JournalExecute();
     statistics.JournalOperations(tx->CountOperations());
@@ -511,6 +497,7 @@ void SpectrumNoPartialPreSchedExecutor::ReExecute() {
 void SpectrumNoPartialPreSchedExecutor::Finalize() {
     DLOG(INFO) << "spectrum finalize " << tx->id;
     last_finalized.fetch_add(1, std::memory_order_seq_cst);
+    signal.Notify();
     for (auto entry: tx->tuples_get) {
         table.ClearGet(tx.get(), entry.key, entry.version);
     }
@@ -532,7 +519,7 @@ void SpectrumNoPartialPreSchedExecutor::Finalize() {
 /// @brief schedule a transaction (put back to queue, swap a nullptr into it)
 void SpectrumNoPartialPreSchedExecutor::Schedule() {
     // no available transaction, so we have to generate one!
-    if(queue.Size() != 0) { tx = queue.Pop(); return; }
+    if ((tx = queue.Pop()) != nullptr) { Install(); return; }
     tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
     tx->start_time = steady_clock::now();
     // prepare lock table, and gather lock information
@@ -543,13 +530,17 @@ void SpectrumNoPartialPreSchedExecutor::Schedule() {
         lock_table.Put(tx.get(), k);
     }
     // wait lock table to stablize
-    while (!stop_flag.load() && last_scheduled.load() + 1 != tx->id) continue;
+    auto wait_start = steady_clock::now();
+    signal.Wait([&]{ return stop_flag.load() || last_scheduled.load() + 1 == tx->id; });
+    wait_time += steady_clock::now() - wait_start;
     last_scheduled.fetch_add(1);
+    signal.Notify();
 }
 
 
 /// @brief start an executor
 void SpectrumNoPartialPreSchedExecutor::Run() {
+    auto start_time = steady_clock::now();
     while (!stop_flag.load()) {
         // find smallest workable transaction
         Schedule();
@@ -566,6 +557,7 @@ void SpectrumNoPartialPreSchedExecutor::Run() {
             queue.Push(std::move(tx));
         }
     }
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
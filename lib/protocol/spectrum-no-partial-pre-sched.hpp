@@ -2,6 +2,10 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
+#include <spectrum/common/wait-util.hpp>
 #include <list>
 #include <atomic>
 #include <tuple>
@@ -14,7 +18,7 @@
 namespace spectrum {
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumNoPartialPreSchedVersionList
 #define T SpectrumNoPartialPreSchedTransaction
 
@@ -38,11 +42,14 @@ struct SpectrumNoPartialPreSchedTransaction: public Transaction {
     size_t      id;
     SpinLock            rerun_keys_mu;
     std::vector<K>      rerun_keys;
+    // set together with rerun_keys under rerun_keys_mu, but read without it
+    std::atomic<bool>   war{false};
     std::atomic<bool>   berun_flag{false};
     std::unordered_map<K, size_t, KeyHasher>    should_wait;
     time_point<steady_clock>                    start_time;
     std::vector<SpectrumNoPartialPreSchedGetTuple>       tuples_get{};
     std::vector<SpectrumNoPartialPreSchedPutTuple>       tuples_put{};
+    LocalIndex<K, KeyHasher>                             local_index;
     SpectrumNoPartialPreSchedTransaction(Transaction&& inner, size_t id);
     bool    HasWAR();
     void    SetWAR(const K& key, size_t writer_id, bool pre_schedule);
@@ -53,14 +60,16 @@ struct SpectrumNoPartialPreSchedEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
 struct SpectrumNoPartialPreSchedVersionList {
     T*          tx = nullptr;
-    std::list<SpectrumNoPartialPreSchedEntry> entries;
+    VersionVector<SpectrumNoPartialPreSchedEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    using allocator_type = VersionVector<SpectrumNoPartialPreSchedEntry>::allocator_type;
+    SpectrumNoPartialPreSchedVersionList(const allocator_type& alloc = {}): entries{alloc} {}
 };
 
 struct SpectrumNoPartialPreSchedLockTable: private Table<K, V, KeyHasher> {
@@ -70,6 +79,9 @@ struct SpectrumNoPartialPreSchedLockTable: private Table<K, V, KeyHasher> {
     void Put(T* tx, const K& k);
     void ClearPut(T* tx, const K& k);
     void ClearGet(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
@@ -82,10 +94,13 @@ struct SpectrumNoPartialPreSchedTable: private Table<K, V, KeyHasher> {
     void RegretPut(T* tx, const K& k);
     void ClearGet(T* tx, const K& k, size_t version);
     void ClearPut(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
-using SpectrumNoPartialPreSchedQueue = LockPriorityQueue<T>;
+using SpectrumNoPartialPreSchedQueue = RingPriorityQueue<T>;
 class SpectrumNoPartialPreSchedExecutor;
 
 class SpectrumNoPartialPreSched: public Protocol {
@@ -101,6 +116,9 @@ class SpectrumNoPartialPreSched: public Protocol {
     std::atomic<size_t>         last_scheduled{0};
     std::atomic<size_t>         last_committed{0};
     std::atomic<bool>           stop_flag{false};
+    Signal                      signal;
+    // transactions put back by any executor, picked up by the next idle one
+    SpectrumNoPartialPreSchedQueue queue;
     std::vector<std::thread>    executors{};
     std::barrier<std::function<void()>>  stop_latch;
     friend class SpectrumNoPartialPreSchedExecutor;
@@ -126,14 +144,17 @@ class SpectrumNoPartialPreSchedExecutor {
     std::atomic<size_t>&        last_scheduled;
     std::atomic<size_t>&        last_committed;
     std::atomic<bool>&          stop_flag;
-    SpectrumNoPartialPreSchedQueue       queue;
+    Signal&                     signal;
+    SpectrumNoPartialPreSchedQueue&      queue;
     std::list<TP>               idle_queue;
     std::unique_ptr<T>          tx{nullptr};
+    nanoseconds                 wait_time{0};
     std::barrier<std::function<void()>>& stop_latch;
 
     public:
     SpectrumNoPartialPreSchedExecutor(SpectrumNoPartialPreSched& spectrum);
     void Finalize();
+    void Install();
     void Execute();
     void Schedule();
     void ReExecute();
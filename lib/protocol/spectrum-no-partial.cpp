@@ -7,7 +7,6 @@
 #include <thread>
 #include <chrono>
 #include <glog/logging.h>
-#include <ranges>
 #include <fmt/core.h>
 
 /*
@@ -20,7 +19,7 @@ namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumNoPartialVersionList
 #define T SpectrumNoPartialTransaction
 
@@ -36,8 +35,7 @@ SpectrumNoPartialTransaction::SpectrumNoPartialTransaction(Transaction&& inner,
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SpectrumNoPartialTransaction::HasWAR() {
-    auto guard = Guard{rerun_keys_mu};
-    return rerun_keys.size() != 0;
+    return war.load(std::memory_order_relaxed);
 }
 
 /// @brief call the transaction to rerun providing the key that caused it
@@ -45,7 +43,9 @@ bool SpectrumNoPartialTransaction::HasWAR() {
 void SpectrumNoPartialTransaction::SetWAR(const K& key, size_t cause_id) {
     auto guard = Guard{rerun_keys_mu};
     rerun_keys.push_back(key);
+    war.store(true, std::memory_order_relaxed);
     should_wait = std::max(should_wait, cause_id);
+    if (signal != nullptr) { signal->Notify(); }
 }
 
 /// @brief the multi-version table for spectrum
@@ -60,17 +60,14 @@ SpectrumNoPartialTable::SpectrumNoPartialTable(size_t partitions):
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SpectrumNoPartialTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -87,23 +84,19 @@ void SpectrumNoPartialTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& ve
 void SpectrumNoPartialTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto _tx: rit->readers) {
+            for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 if (_tx->id > tx->id) {
                     DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                     _tx->SetWAR(k, tx->id);
                 }
             }
-            break;
         }
         for (auto _tx: _v.readers_default) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
@@ -113,15 +106,15 @@ void SpectrumNoPartialTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
             }
         }
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value = v;
+        if (vit != end && vit->version == tx->id) {
+            vit->value = v;
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SpectrumNoPartialEntry {
+        _v.entries.Insert(SpectrumNoPartialEntry {
             .value   = v,
             .version = tx->id,
-            .readers = std::unordered_set<T*>()
+            .readers = ReaderSet<T>()
         });
     });
 }
@@ -131,15 +124,11 @@ void SpectrumNoPartialTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
 /// @param k the key of read entry
 void SpectrumNoPartialTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -167,22 +156,18 @@ void SpectrumNoPartialTable::RegretGet(T* tx, const K& k, size_t version) {
 /// @param k the key of this put entry
 void SpectrumNoPartialTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             // abort transactions that read from current transaction
             for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, tx->id);
             }
-            break;
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
@@ -192,16 +177,12 @@ void SpectrumNoPartialTable::RegretPut(T* tx, const K& k) {
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SpectrumNoPartialTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -229,10 +210,8 @@ void SpectrumNoPartialTable::ClearGet(T* tx, const K& k, size_t version) {
 /// @param k the key of written entry
 void SpectrumNoPartialTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -265,7 +244,10 @@ void SpectrumNoPartial::Start() {
 /// @brief stop spectrum protocol
 void SpectrumNoPartial::Stop() {
     stop_flag.store(true);
+    signal.Notify();
     for (auto& x: executors) 	{ x.join(); }
+    statistics.JournalLocks(table.CountLocks());
+    statistics.JournalAccesses(table.CountLocalAccesses(), table.CountRemoteAccesses());
 }
 
 /// @brief spectrum executor
@@ -274,6 +256,7 @@ SpectrumNoPartialExecutor::SpectrumNoPartialExecutor(SpectrumNoPartial& spectrum
     table{spectrum.table},
     last_finalized{spectrum.last_finalized},
     stop_flag{spectrum.stop_flag},
+    signal{spectrum.signal},
     statistics{spectrum.statistics},
     workload{spectrum.workload},
     last_executed{spectrum.last_executed},
@@ -285,13 +268,15 @@ void SpectrumNoPartialExecutor::Generate() {
     if(tx != nullptr) return;
     tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
     tx->start_time = steady_clock::now();
+    tx->signal = &signal;
     tx->berun_flag.store(true);
     tx->InstallSetStorageHandler([this](
         const evmc::address &addr, 
         const evmc::bytes32 &key, 
         const evmc::bytes32 &value
     ) {
-        auto _key = std::make_tuple(addr, key);
+        auto _key = K(addr, key);
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back({
             .key = _key, 
             .value = value, 
@@ -310,23 +295,22 @@ void SpectrumNoPartialExecutor::Generate() {
         const evmc::address &addr, 
         const evmc::bytes32 &key
     ) {
-        auto _key  = std::make_tuple(addr, key);
+        auto _key  = K(addr, key);
         auto value = evmc::bytes32{0};
         auto version = size_t{0};
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_put. ";
-            return tup.value;
+            return tx->tuples_put[i].value;
         }
-        for (auto& tup: tx->tuples_get) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindGet(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_get. ";
-            return tup.value;
+            return tx->tuples_get[i].value;
         }
         DLOG(INFO) << "tx " << tx->id << " " << 
             " read(" << tx->tuples_get.size() << ")" << 
             " key(" << KeyHasher()(_key) % 1000 << ")" << std::endl;
         table.Get(tx.get(), _key, value, version);
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back({
             .key            = _key, 
             .value          = value, 
@@ -359,7 +343,11 @@ void SpectrumNoPartialExecutor::Generate() {
 /// @param tx the transaction to rollback
 void SpectrumNoPartialExecutor::ReExecute() {
     DLOG(INFO) << "spectrum-no-partial re-execute " << tx->id;
-    tx->rerun_keys.clear();
+    {
+        auto guard = Guard{tx->rerun_keys_mu};
+        tx->rerun_keys.clear();
+        tx->war.store(false, std::memory_order_relaxed);
+    }
     tx->ApplyCheckpoint(0);
     for (auto entry: tx->tuples_get) {
         table.RegretGet(tx.get(), entry.key, entry.version);
@@ -368,7 +356,9 @@ void SpectrumNoPartialExecutor::ReExecute() {
         table.RegretPut(tx.get(), entry.key);
     }
     tx->tuples_put.resize(0);
+    tx->local_index.TruncatePut(0);
     tx->tuples_get.resize(0);
+    tx->local_index.TruncateGet(0);
     tx->Execute();
     statistics.JournalExecute();
     statistics.JournalOperations(tx->CountOperations());
@@ -383,6 +373,7 @@ void SpectrumNoPartialExecutor::ReExecute() {
 void SpectrumNoPartialExecutor::Finalize() {
     DLOG(INFO) << "spectrum finalize " << tx->id;
     last_finalized.fetch_add(1, std::memory_order_seq_cst);
+    signal.Notify();
     for (auto entry: tx->tuples_get) {
         table.ClearGet(tx.get(), entry.key, entry.version);
     }
@@ -396,6 +387,7 @@ void SpectrumNoPartialExecutor::Finalize() {
 
 /// @brief start an executor
 void SpectrumNoPartialExecutor::Run() {
+    auto start_time = steady_clock::now();
     while (!stop_flag.load()) {
         // first generate a transaction
         Generate();
@@ -408,7 +400,14 @@ void SpectrumNoPartialExecutor::Run() {
             // then i can final commit and do another transaction. 
             Finalize();
         }
+        else {
+            // nothing to do until the previous transaction finalizes or this one has to re-execute
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{ return stop_flag.load() || last_finalized.load() + 1 == tx->id || tx->HasWAR(); });
+            wait_time += steady_clock::now() - wait_start;
+        }
     }
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
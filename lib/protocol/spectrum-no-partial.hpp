@@ -2,7 +2,10 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
-#include <list>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
+#include <spectrum/common/wait-util.hpp>
 #include <atomic>
 #include <tuple>
 #include <vector>
@@ -13,7 +16,7 @@
 namespace spectrum {
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumNoPartialVersionList
 #define T SpectrumNoPartialTransaction
 
@@ -38,10 +41,15 @@ struct SpectrumNoPartialTransaction: public Transaction {
     size_t      should_wait{0};
     SpinLock            rerun_keys_mu;
     std::vector<K>      rerun_keys;
+    // set together with rerun_keys under rerun_keys_mu, but read without it
+    std::atomic<bool>   war{false};
     std::atomic<bool>   berun_flag{false};
     time_point<steady_clock>            start_time;
+    // notified when this transaction has to re-execute
+    Signal*     signal{nullptr};
     std::vector<SpectrumNoPartialGetTuple>       tuples_get{};
     std::vector<SpectrumNoPartialPutTuple>       tuples_put{};
+    LocalIndex<K, KeyHasher>                     local_index;
     SpectrumNoPartialTransaction(Transaction&& inner, size_t id);
     bool HasWAR();
     void SetWAR(const K& key, size_t cause_id);
@@ -51,14 +59,16 @@ struct SpectrumNoPartialEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
 struct SpectrumNoPartialVersionList {
     T*          tx = nullptr;
-    std::list<SpectrumNoPartialEntry> entries;
+    VersionVector<SpectrumNoPartialEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    using allocator_type = VersionVector<SpectrumNoPartialEntry>::allocator_type;
+    SpectrumNoPartialVersionList(const allocator_type& alloc = {}): entries{alloc} {}
 };
 
 struct SpectrumNoPartialTable: private Table<K, V, KeyHasher> {
@@ -70,6 +80,9 @@ struct SpectrumNoPartialTable: private Table<K, V, KeyHasher> {
     void RegretPut(T* tx, const K& k);
     void ClearGet(T* tx, const K& k, size_t version);
     void ClearPut(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
@@ -86,6 +99,7 @@ class SpectrumNoPartial: public Protocol {
     std::atomic<size_t> last_executed{1};
     std::atomic<size_t> last_finalized{0};
     std::atomic<bool>   stop_flag{false};
+    Signal              signal;
     std::vector<std::thread>    executors{};
     std::barrier<std::function<void()>>            stop_latch;
     friend class SpectrumNoPartialExecutor;
@@ -106,8 +120,10 @@ class SpectrumNoPartialExecutor {
     std::atomic<size_t>&    last_executed;
     std::atomic<size_t>&    last_finalized;
     std::atomic<bool>&      stop_flag;
+    Signal&                 signal;
     SpectrumNoPartialQueue           queue;
     std::unique_ptr<T>      tx{nullptr};
+    nanoseconds             wait_time{0};
     std::barrier<std::function<void()>>&           stop_latch;
 
     public:
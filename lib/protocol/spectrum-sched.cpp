@@ -6,7 +6,6 @@
 #include <thread>
 #include <chrono>
 #include <glog/logging.h>
-#include <ranges>
 #include <fmt/core.h>
 
 /*
@@ -17,7 +16,7 @@ namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumSchedVersionList
 #define T SpectrumSchedTransaction
 
@@ -33,8 +32,7 @@ SpectrumSchedTransaction::SpectrumSchedTransaction(Transaction&& inner, size_t i
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SpectrumSchedTransaction::HasWAR() {
-    auto guard = Guard{rerun_keys_mu};
-    return rerun_keys.size() != 0;
+    return war.load(std::memory_order_relaxed);
 }
 
 /// @brief call the transaction to rerun providing the key that caused it
@@ -42,6 +40,7 @@ bool SpectrumSchedTransaction::HasWAR() {
 void SpectrumSchedTransaction::SetWAR(const K& key, size_t cause_id) {
     auto guard = Guard{rerun_keys_mu};
     rerun_keys.push_back(key);
+    war.store(true, std::memory_order_relaxed);
     should_wait = std::max(should_wait, cause_id);
 }
 
@@ -57,17 +56,14 @@ SpectrumSchedTable::SpectrumSchedTable(size_t partitions):
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SpectrumSchedTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -83,23 +79,19 @@ void SpectrumSchedTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& versio
 void SpectrumSchedTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
     CHECK(tx->id > 0) << "we reserve version(0) for default value";
     DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        // the version right before insertion position
+        if (vit != end) {
             // abort transactions that read outdated keys
-            for (auto _tx: rit->readers) {
+            for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 if (_tx->id > tx->id) {
                     DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                     _tx->SetWAR(k, tx->id);
                 }
             }
-            break;
         }
         for (auto _tx: _v.readers_default) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
@@ -109,15 +101,15 @@ void SpectrumSchedTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
             }
         }
         // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value = v;
+        if (vit != end && vit->version == tx->id) {
+            vit->value = v;
             return;
         }
         // insert an entry
-        _v.entries.insert(rit.base(), SpectrumSchedEntry {
+        _v.entries.Insert(SpectrumSchedEntry {
             .value   = v,
             .version = tx->id,
-            .readers = std::unordered_set<T*>()
+            .readers = ReaderSet<T>()
         });
     });
 }
@@ -127,15 +119,11 @@ void SpectrumSchedTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
 /// @param k the key of read entry
 void SpectrumSchedTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -163,22 +151,18 @@ void SpectrumSchedTable::RegretGet(T* tx, const K& k, size_t version) {
 /// @param k the key of this put entry
 void SpectrumSchedTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             // abort transactions that read from current transaction
             for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, tx->id);
             }
-            break;
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
@@ -188,16 +172,12 @@ void SpectrumSchedTable::RegretPut(T* tx, const K& k) {
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SpectrumSchedTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Table::Update(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -225,10 +205,8 @@ void SpectrumSchedTable::ClearGet(T* tx, const K& k, size_t version) {
 /// @param k the key of written entry
 void SpectrumSchedTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
-        }
+    Table::Update(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
     });
 }
 
@@ -262,6 +240,8 @@ void SpectrumSched::Start() {
 void SpectrumSched::Stop() {
     stop_flag.store(true);
     for (auto& x: executors) 	{ x.join(); }
+    statistics.JournalLocks(table.CountLocks());
+    statistics.JournalAccesses(table.CountLocalAccesses(), table.CountRemoteAccesses());
 }
 
 /// @brief spectrum executor
@@ -288,7 +268,8 @@ void SpectrumSchedExecutor::Generate() {
         const evmc::bytes32 &value
     ) {
         auto tx = tx_ref;
-        auto _key   = std::make_tuple(addr, key);
+        auto _key   = K(addr, key);
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back({
             .key = _key, 
             .value = value, 
@@ -302,18 +283,19 @@ void SpectrumSchedExecutor::Generate() {
         const evmc::bytes32 &key
     ) {
         auto tx = tx_ref;
-        auto _key   = std::make_tuple(addr, key);
+        auto _key   = K(addr, key);
         auto value  = evmc::bytes32{0};
         auto version = size_t{0};
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (tup.key == _key) { return tup.value; }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
+            return tx->tuples_put[i].value;
         }
-        for (auto& tup: tx->tuples_get) {
-            if (tup.key == _key) { return tup.value; }
+        if (auto i = tx->local_index.FindGet(_key); i != tx->local_index.none) {
+            return tx->tuples_get[i].value;
         }
         if (tx->HasWAR()) { tx->Break(); }
         table.Get(tx, _key, value, version);
         size_t checkpoint_id = tx->MakeCheckpoint();
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back({
             .key            = _key, 
             .value          = value, 
@@ -345,14 +327,12 @@ void SpectrumSchedExecutor::ReExecute() {
     {
         auto guard = Guard{tx->rerun_keys_mu}; 
         std::swap(tx->rerun_keys, rerun_keys);
+        tx->war.store(false, std::memory_order_relaxed);
     }
     auto back_to = ~size_t{0};
     // find checkpoint
     for (auto& key: rerun_keys) {
-        for (size_t i = 0; i < tx->tuples_get.size(); ++i) {
-            if (tx->tuples_get[i].key != key) { continue; }
-            back_to = std::min(i, back_to); break;
-        }
+        back_to = std::min(tx->local_index.FindGet(key), back_to);
     }
     // good news: we don't have to rollback
     if (back_to == ~size_t{0}) { return; }
@@ -368,7 +348,9 @@ void SpectrumSchedExecutor::ReExecute() {
         table.RegretGet(tx.get(), tx->tuples_get[i].key, tx->tuples_get[i].version);
     }
     tx->tuples_put.resize(tup.tuples_put_len);
+    tx->local_index.TruncatePut(tup.tuples_put_len);
     tx->tuples_get.resize(back_to);
+    tx->local_index.TruncateGet(back_to);
     tx->Execute();
     statistics.JournalExecute();
     statistics.JournalOperations(tx->CountOperations());
@@ -398,7 +380,8 @@ void SpectrumSchedExecutor::Finalize() {
 }
 
 /// @brief schedule a transaction (put back to queue, swap a nullptr into it)
-void SpectrumSchedExecutor::Schedule() {
+/// @return if no queued transaction was workable and a new one was generated
+bool SpectrumSchedExecutor::Schedule() {
     // find the earliest transaction that is waited
     if (tx != nullptr) {
         for (auto it = idle_queue.begin(); it != idle_queue.end(); ++it) {
@@ -414,25 +397,33 @@ void SpectrumSchedExecutor::Schedule() {
         if ((*it)->should_wait > mark) { continue; }
         tx = std::move(*it); idle_queue.erase(it);
         DLOG(INFO) << "spectrum schedule " << tx->id << std::endl;
-        return;
+        return false;
     }
     // if we cannot find one, we just keep the incoming one in idle_queue and generate another. 
     Generate();
+    return true;
 }
 
 /// @brief start an executor
 void SpectrumSchedExecutor::Run() {
+    auto start_time = steady_clock::now();
     // find smallest workable transaction
     Generate();
     while (!stop_flag.load()) {
-        Schedule();
+        auto round_start = steady_clock::now();
+        auto generated = Schedule();
         if (tx->HasWAR()) {
             ReExecute();
         }
         else if (last_finalized.load() + 1 == tx->id && !tx->HasWAR()) {
             Finalize();
         }
+        else if (!generated) {
+            // this round only rotated the idle queue, waiting for earlier transactions to finalize
+            wait_time += steady_clock::now() - round_start;
+        }
     }
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
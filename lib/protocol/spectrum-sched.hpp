@@ -2,6 +2,9 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
 #include <list>
 #include <atomic>
 #include <tuple>
@@ -13,7 +16,7 @@
 namespace spectrum {
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumSchedVersionList
 #define T SpectrumSchedTransaction
 
@@ -38,10 +41,13 @@ struct SpectrumSchedTransaction: public Transaction {
     size_t      should_wait{0};
     SpinLock            rerun_keys_mu;
     std::vector<K>      rerun_keys;
+    // set together with rerun_keys under rerun_keys_mu, but read without it
+    std::atomic<bool>   war{false};
     std::atomic<bool>   berun_flag{false};
     time_point<steady_clock>                start_time;
     std::vector<SpectrumSchedGetTuple>      tuples_get{};
     std::vector<SpectrumSchedPutTuple>      tuples_put{};
+    LocalIndex<K, KeyHasher>                local_index;
     SpectrumSchedTransaction(Transaction&& inner, size_t id);
     bool HasWAR();
     void SetWAR(const K& key, size_t cause_id);
@@ -51,14 +57,16 @@ struct SpectrumSchedEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
 struct SpectrumSchedVersionList {
     T*          tx = nullptr;
-    std::list<SpectrumSchedEntry> entries;
+    VersionVector<SpectrumSchedEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    using allocator_type = VersionVector<SpectrumSchedEntry>::allocator_type;
+    SpectrumSchedVersionList(const allocator_type& alloc = {}): entries{alloc} {}
 };
 
 struct SpectrumSchedTable: private Table<K, V, KeyHasher> {
@@ -70,6 +78,9 @@ struct SpectrumSchedTable: private Table<K, V, KeyHasher> {
     void RegretPut(T* tx, const K& k);
     void ClearGet(T* tx, const K& k, size_t version);
     void ClearPut(T* tx, const K& k);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
 
 };
 
@@ -111,12 +122,13 @@ class SpectrumSchedExecutor {
     std::list<TP>           idle_queue;
     std::unique_ptr<T>      tx;
     std::barrier<std::function<void()>>& stop_latch;
+    nanoseconds             wait_time{0};
 
     public:
     SpectrumSchedExecutor(SpectrumSched& spectrum);
     void Finalize();
     void Generate();
-    void Schedule();
+    bool Schedule();
     void ReExecute();
     void Run();
 
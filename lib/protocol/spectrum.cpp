@@ -4,11 +4,14 @@
 #include <spectrum/common/hex.hpp>
 #include <spectrum/common/thread-util.hpp>
 #include <functional>
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <glog/logging.h>
-#include <ranges>
 #include <fmt/core.h>
+#include <gflags/gflags.h>
+
+DEFINE_uint64(transaction_pool, 64, "reclaimed transactions each spectrum executor keeps for reuse, 0 frees them right away");
 
 /*
     This is an implementation of "Spectrum: Speedy and Strictly-Deterministic Smart Contract Transactions for Blockchain Ledgers" (Zhihao Chen, Tianji Yang, Yixiao Zheng, Zhao Zhang, Cheqing Jin and Aoying Zhou). 
@@ -19,7 +22,7 @@ namespace spectrum {
 
 using namespace std::chrono;
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumVersionList
 #define T SpectrumTransaction
 
@@ -32,44 +35,208 @@ SpectrumTransaction::SpectrumTransaction(Transaction&& inner, size_t id):
     start_time{std::chrono::steady_clock::now()}
 {}
 
+/// @brief reuse a reclaimed spectrum transaction for a new base transaction, keeping the capacity of its logs
+/// @param inner the base transaction
+/// @param id transaction id
+void SpectrumTransaction::Recycle(Transaction&& inner, size_t id) {
+    Transaction::Recycle(std::move(inner));
+    this->id = id;
+    should_wait = 0;
+    rerun_keys.clear();
+    war.store(false, std::memory_order_relaxed);
+    berun_flag.store(false);
+    start_time = steady_clock::now();
+    tuples_get.clear();
+    tuples_put.clear();
+    local_index.Clear();
+    replay.clear();
+    replay_index.Clear();
+}
+
 /// @brief determine transaction has to rerun
 /// @return if transaction has to rerun
 bool SpectrumTransaction::HasWAR() {
-    auto guard = Guard{rerun_keys_mu};
-    return rerun_keys.size() != 0;
+    return war.load(std::memory_order_relaxed);
 }
 
 /// @brief call the transaction to rerun providing the key that caused it
 /// @param key the key that caused rerun
 void SpectrumTransaction::SetWAR(const K& key, size_t cause_id) {
-    auto guard = Guard{rerun_keys_mu};
-    rerun_keys.push_back(key);
-    should_wait = std::max(should_wait, cause_id);
+    {
+        auto guard = Guard{rerun_keys_mu};
+        rerun_keys.push_back(key);
+        war.store(true, std::memory_order_relaxed);
+        should_wait = std::max(should_wait, cause_id);
+    }
+    if (parking != nullptr) { parking->Flag(id); }
+    if (signal != nullptr) { signal->Notify(); }
+}
+
+/// @brief serve a read from the reads that survived the last rollback
+/// @param key the key to read
+/// @param value (mutated to be) the value read before the rollback
+/// @param version (mutated to be) the version read before the rollback
+/// @return if the read is served
+bool SpectrumTransaction::Replay(const K& key, evmc::bytes32& value, size_t& version) {
+    auto i = replay_index.FindGet(key);
+    if (i == replay_index.none || replay[i].replayed) { return false; }
+    value   = replay[i].value;
+    version = replay[i].version;
+    replay[i].replayed = true;
+    return true;
 }
 
 /// @brief the multi-version table for spectrum
 /// @param partitions the number of partitions
 SpectrumTable::SpectrumTable(size_t partitions):
-    Table<K, V, KeyHasher>{partitions}
+    Table<K, V, KeyHasher>{partitions},
+    hot_index{new std::atomic<SpectrumHotEntry*>[hot_capacity]{}}
 {}
 
+/// @brief free hot entries, which are owned by the hot index
+SpectrumTable::~SpectrumTable() {
+    for (size_t i = 0; i < hot_capacity; ++i) {
+        delete hot_index[i].load();
+    }
+}
+
+/// @brief find the hot entry of a key without taking any lock
+/// @param k the key
+/// @return the hot entry, or nullptr if the key is still in its partition
+SpectrumHotEntry* SpectrumTable::FindHot(const K& k) {
+    if (hot_count.load(std::memory_order_acquire) == 0) { return nullptr; }
+    auto h = KeyHasher()(k);
+    for (size_t i = 0; i < hot_probe; ++i) {
+        auto hot = hot_index[(h + i) % hot_capacity].load(std::memory_order_acquire);
+        if (hot == nullptr) { return nullptr; }
+        if (hot->key == k) { return hot; }
+    }
+    return nullptr;
+}
+
+/// @brief move a contended key out of its partition into the hot index
+/// @param k the key
+/// @param _v the version list of the key, with its partition lock held
+void SpectrumTable::Promote(const K& k, V& _v) {
+    auto hot = new SpectrumHotEntry{.key = k};
+    auto h = KeyHasher()(k);
+    for (size_t i = 0; i < hot_probe; ++i) {
+        // lock the entry before publishing it, so early finders wait until the versions are moved in
+        auto guard = Guard{hot->mu};
+        auto expected = (SpectrumHotEntry*) nullptr;
+        if (!hot_index[(h + i) % hot_capacity].compare_exchange_strong(expected, hot, std::memory_order_acq_rel)) {
+            continue;
+        }
+        DLOG(INFO) << "promote hot key " << h % 1000 << " with " << _v.aborts << " aborts";
+        hot->value.entries.Reserve(hot_versions);
+        for (auto& entry: _v.entries) {
+            hot->value.entries.Insert(std::move(entry));
+        }
+        _v.entries.TruncateBefore(~size_t{0});
+        hot->value.readers_default = std::move(_v.readers_default);
+        hot->value.accesses = _v.accesses;
+        hot->value.aborts   = _v.aborts;
+        _v.hot = hot;
+        hot_count.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    // the hot index is full around this key, so count it again from scratch
+    _v.aborts = 0;
+    delete hot;
+}
+
+/// @brief sample an access to a version list, halving its counters once they span a window
+/// @param _v the version list, with its lock held
+/// @param every the sampling interval
+/// @param window the number of accesses after which counters decay
+static void Sample(V& _v, size_t every, size_t window) {
+    static thread_local size_t count = 0;
+    if (++count % every != 0) { return; }
+    _v.accesses += every;
+    if (_v.accesses >= window) { _v.accesses /= 2; _v.aborts /= 2; }
+}
+
+/// @brief run a callback on the version list of a key with its partition lock held, following it to the hot index if it moved
+/// @param k the key
+/// @param _v the version list in the partition
+/// @param vmap the callback receiving a mutable reference to the version list
+template<typename F>
+void SpectrumTable::AccessLocked(const K& k, V& _v, F&& vmap) {
+    if (_v.hot != nullptr) {
+        auto guard = Guard{_v.hot->mu};
+        Sample(_v.hot->value, hot_sample, hot_window);
+        vmap(_v.hot->value);
+        return;
+    }
+    Sample(_v, hot_sample, hot_window);
+    vmap(_v);
+    if (_v.aborts >= hot_threshold) { Promote(k, _v); }
+}
+
+/// @brief run a callback on the version list of a key, hot keys skip the partition lock
+/// @param k the key
+/// @param vmap the callback receiving a mutable reference to the version list
+template<typename F>
+void SpectrumTable::Access(const K& k, F&& vmap) {
+    if (auto hot = FindHot(k)) {
+        auto guard = Guard{hot->mu};
+        Sample(hot->value, hot_sample, hot_window);
+        vmap(hot->value);
+        return;
+    }
+    Table::Update(k, [&](V& _v) { AccessLocked(k, _v, vmap); });
+}
+
+/// @brief run a callback on the version lists of many keys, taking each partition lock once
+/// @param items the items to apply
+/// @param key the projection from an item to its key
+/// @param vmap the callback receiving an item and a mutable reference to its version list
+template<typename I, typename P, typename F>
+void SpectrumTable::AccessBatch(std::vector<I>& items, P&& key, F&& vmap) {
+    auto cold = std::vector<I>();
+    auto hot  = std::vector<std::pair<I, SpectrumHotEntry*>>();
+    for (auto& item: items) {
+        if (auto entry = FindHot(key(item))) { hot.push_back({item, entry}); }
+        else { cold.push_back(item); }
+    }
+    // keys are never demoted, so items of one key classified cold always precede those classified hot
+    Table::UpdateBatch(cold, key, [&](I& item, V& _v) {
+        AccessLocked(key(item), _v, [&](V& _v) { vmap(item, _v); });
+    });
+    for (auto& [item, entry]: hot) {
+        auto guard = Guard{entry->mu};
+        Sample(entry->value, hot_sample, hot_window);
+        vmap(item, entry->value);
+    }
+}
+
+/// @brief the hot keys with their sampled accesses and aborted readers
+/// @return a list of (key, accesses, aborts)
+std::vector<std::tuple<K, size_t, size_t>> SpectrumTable::HotKeys() {
+    auto hot_keys = std::vector<std::tuple<K, size_t, size_t>>();
+    for (size_t i = 0; i < hot_capacity; ++i) {
+        auto hot = hot_index[i].load(std::memory_order_acquire);
+        if (hot == nullptr) { continue; }
+        auto guard = Guard{hot->mu};
+        hot_keys.push_back({hot->key, hot->value.accesses, hot->value.aborts});
+    }
+    return hot_keys;
+}
+
 /// @brief get a value
 /// @param tx the transaction that reads the value
 /// @param k the key of the read entry
 /// @param v (mutated to be) the value of read entry
 /// @param version (mutated to be) the version of read entry
 void SpectrumTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            v = rit->value;
-            version = rit->version;
-            rit->readers.insert(tx);
-            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << rit->version << std::endl;
+    Access(k, [&](V& _v) {
+        auto vit = _v.entries.Floor(tx->id);
+        auto end = _v.entries.end();
+        if (vit != end) {
+            v = vit->value;
+            version = vit->version;
+            vit->readers.insert(tx);
+            DLOG(INFO) << tx->id << "(" << tx << ")" << " read " << KeyHasher()(k) % 1000 << " version " << vit->version << std::endl;
             return;
         }
         version = 0;
@@ -79,49 +246,72 @@ void SpectrumTable::Get(T* tx, const K& k, evmc::bytes32& v, size_t& version) {
     });
 }
 
-/// @brief put a value
+/// @brief insert a version into a locked version list, aborting transactions that read outdated keys
 /// @param tx the transaction that writes the value
 /// @param k the key of the written entry
 /// @param v the value to write
-void SpectrumTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
-    CHECK(tx->id > 0) << "we reserve version(0) for default value";
-    DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto rit = _v.entries.rbegin();
-        auto end = _v.entries.rend();
-        // search from insertion position
-        while (rit != end) {
-            if (rit->version > tx->id) {
-                ++rit; continue;
-            }
-            // abort transactions that read outdated keys
-            for (auto _tx: rit->readers) {
-                DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
-                if (_tx->id > tx->id) {
-                    DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
-                    _tx->SetWAR(k, tx->id);
-                }
-            }
-            break;
-        }
-        for (auto _tx: _v.readers_default) {
+/// @param _v the version list of the written entry
+static void PutVersion(T* tx, const K& k, const evmc::bytes32& v, V& _v) {
+    auto vit = _v.entries.Floor(tx->id);
+    auto end = _v.entries.end();
+    // the version right before insertion position
+    if (vit != end) {
+        // abort transactions that read outdated keys
+        for (auto _tx: vit->readers) {
             DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
             if (_tx->id > tx->id) {
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, tx->id);
+                _v.aborts += 1;
             }
         }
-        // handle duplicated write on the same key
-        if (rit != end && rit->version == tx->id) {
-            rit->value = v;
-            return;
+    }
+    for (auto _tx: _v.readers_default) {
+        DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
+        if (_tx->id > tx->id) {
+            DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
+            _tx->SetWAR(k, tx->id);
+            _v.aborts += 1;
         }
-        // insert an entry
-        _v.entries.insert(rit.base(), SpectrumEntry {
-            .value   = v,
-            .version = tx->id,
-            .readers = std::unordered_set<T*>()
-        });
+    }
+    // handle duplicated write on the same key
+    if (vit != end && vit->version == tx->id) {
+        vit->value = v;
+        return;
+    }
+    // insert an entry
+    _v.entries.Insert(SpectrumEntry {
+        .value   = v,
+        .version = tx->id,
+        .readers = ReaderSet<T>()
+    });
+}
+
+/// @brief put a value
+/// @param tx the transaction that writes the value
+/// @param k the key of the written entry
+/// @param v the value to write
+void SpectrumTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
+    CHECK(tx->id > 0) << "we reserve version(0) for default value";
+    DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << KeyHasher()(k) % 1000 << std::endl;
+    Access(k, [&](V& _v) {
+        PutVersion(tx, k, v, _v);
+    });
+}
+
+/// @brief put all uncommitted values of a transaction, taking each partition lock once
+/// @param tx the transaction that writes the values
+/// @param tuples_put the put log of the transaction, whose entries are marked committed
+void SpectrumTable::PutBatch(T* tx, std::vector<SpectrumPutTuple>& tuples_put) {
+    CHECK(tx->id > 0) << "we reserve version(0) for default value";
+    auto puts = std::vector<SpectrumPutTuple*>();
+    for (auto& entry: tuples_put) {
+        if (!entry.is_committed) { puts.push_back(&entry); }
+    }
+    DLOG(INFO) << tx->id << "(" << tx << ")" << " write " << puts.size() << " keys" << std::endl;
+    AccessBatch(puts, [](SpectrumPutTuple* entry) -> const K& { return entry->key; }, [&](SpectrumPutTuple* entry, V& _v) {
+        PutVersion(tx, entry->key, entry->value, _v);
+        entry->is_committed = true;
     });
 }
 
@@ -130,15 +320,11 @@ void SpectrumTable::Put(T* tx, const K& k, const evmc::bytes32& v) {
 /// @param k the key of read entry
 void SpectrumTable::RegretGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Access(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -166,41 +352,54 @@ void SpectrumTable::RegretGet(T* tx, const K& k, size_t version) {
 /// @param k the key of this put entry
 void SpectrumTable::RegretPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Access(k, [&](V& _v) {
+        auto vit = _v.entries.Find(tx->id);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != tx->id) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             // abort transactions that read from current transaction
             for (auto _tx: vit->readers) {
                 DLOG(INFO) << KeyHasher()(k) % 1000 << " has read dependency " << "(" << _tx << ")" << std::endl;
                 DLOG(INFO) << tx->id << " abort " << _tx->id << std::endl;
                 _tx->SetWAR(k, tx->id);
+                _v.aborts += 1;
             }
-            break;
+            _v.entries.Erase(vit);
         }
-        if (vit != end) { _v.entries.erase(vit); }
     });
 }
 
+/// @brief remove committed writes past a rollback point, and mark earlier writes to the same keys uncommitted
+/// @param tx the transaction that rolls back
+/// @param tuples_put the put log of the transaction
+/// @param from the length of the put log that survives the rollback
+void SpectrumTable::RegretPutBatch(T* tx, std::vector<SpectrumPutTuple>& tuples_put, size_t from) {
+    auto regret_keys = std::vector<K>();
+    for (size_t i = from; i < tuples_put.size(); ++i) {
+        if (!tuples_put[i].is_committed) { continue; }
+        RegretPut(tx, tuples_put[i].key);
+        regret_keys.push_back(tuples_put[i].key);
+    }
+    // regretting a key erases our whole version of it, so surviving writes to it have to be put again
+    for (size_t i = 0; i < from && i < tuples_put.size(); ++i) {
+        auto& entry = tuples_put[i];
+        if (std::find(regret_keys.begin(), regret_keys.end(), entry.key) != regret_keys.end()) {
+            entry.is_committed = false;
+        }
+    }
+}
+
 /// @brief remove a read dependency from this entry
 /// @param tx the transaction that previously read this entry
 /// @param k the key of read entry
 /// @param version the version of read entry, which indicates the transaction that writes this value
 void SpectrumTable::ClearGet(T* tx, const K& k, size_t version) {
     DLOG(INFO) << "remove read record " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        auto vit = _v.entries.begin();
+    Access(k, [&](V& _v) {
+        auto vit = _v.entries.Find(version);
         auto end = _v.entries.end();
-        while (vit != end) {
-            if (vit->version != version) {
-                ++vit; continue;
-            }
+        if (vit != end) {
             DLOG(INFO) << "remove " << tx->id << "(" << tx << ")" << " from version " << vit->version << std::endl; 
             vit->readers.erase(tx);
-            break;
         }
         if (version == 0) {
             _v.readers_default.erase(tx);
@@ -228,13 +427,88 @@ void SpectrumTable::ClearGet(T* tx, const K& k, size_t version) {
 /// @param k the key of written entry
 void SpectrumTable::ClearPut(T* tx, const K& k) {
     DLOG(INFO) << "remove write record before " << tx->id << "(" << tx << ")" << " from " << KeyHasher()(k) % 1000 << std::endl;
-    Table::Put(k, [&](V& _v) {
-        while (_v.entries.size() && _v.entries.front().version < tx->id) {
-            _v.entries.pop_front();
+    Access(k, [&](V& _v) {
+        _v.entries.TruncateBefore(tx->id);
+    });
+}
+
+/// @brief clear the reads and writes of finalized transactions in one pass over partitions
+/// @param txs the finalized transactions, which must stay alive until this returns
+void SpectrumTable::ClearBatch(std::vector<std::unique_ptr<T>>& txs) {
+    struct Clear {
+        const K*    key;
+        T*          tx;
+        size_t      version;
+        bool        is_put;
+    };
+    auto clears = std::vector<Clear>();
+    for (auto& tx: txs) {
+        for (auto& entry: tx->tuples_get) {
+            clears.push_back({.key = &entry.key, .tx = tx.get(), .version = entry.version, .is_put = false});
+        }
+        for (auto& entry: tx->tuples_put) {
+            clears.push_back({.key = &entry.key, .tx = tx.get(), .version = 0, .is_put = true});
+        }
+    }
+    // every cleared transaction is below the finalized watermark, so the order of clears doesn't matter
+    AccessBatch(clears, [](const Clear& c) -> const K& { return *c.key; }, [](const Clear& c, V& _v) {
+        if (c.is_put) {
+            _v.entries.TruncateBefore(c.tx->id);
+            return;
+        }
+        auto vit = _v.entries.Find(c.version);
+        if (vit != _v.entries.end()) {
+            vit->readers.erase(c.tx);
+        }
+        if (c.version == 0) {
+            _v.readers_default.erase(c.tx);
         }
     });
 }
 
+/// @brief an empty hint table
+SpectrumHints::SpectrumHints():
+    slots{new std::atomic<size_t>[capacity]{}}
+{}
+
+/// @brief record that a transaction is about to write a key, higher ids win the slot
+/// @param k the key
+/// @param id the writer id
+void SpectrumHints::Predict(const K& k, size_t id) {
+    auto& slot = slots[KeyHasher()(k) % capacity];
+    auto v = slot.load(std::memory_order_relaxed);
+    while ((v >> 1) < id && !slot.compare_exchange_weak(v, id << 1, std::memory_order_relaxed)) {}
+}
+
+/// @brief record that the write of a transaction is visible in the table
+/// @param k the key
+/// @param id the writer id
+void SpectrumHints::Written(const K& k, size_t id) {
+    auto v = id << 1;
+    slots[KeyHasher()(k) % capacity].compare_exchange_strong(v, v | 1, std::memory_order_relaxed);
+}
+
+/// @brief hold a read back for a bounded while, if a lower unfinalized transaction is predicted to write the key
+/// @param k the key to read
+/// @param tx the reading transaction
+/// @param last_finalized the id of the last finalized transaction
+void SpectrumHints::Defer(const K& k, T* tx, std::atomic<size_t>& last_finalized) {
+    auto& slot = slots[KeyHasher()(k) % capacity];
+    auto v = slot.load(std::memory_order_relaxed);
+    if ((v & 1) || (v >> 1) >= tx->id || (v >> 1) <= last_finalized.load()) { return; }
+    count_defer.fetch_add(1, std::memory_order_relaxed);
+    // never park here, a parked frontier would wait for us while we wait for it
+    auto backoff = Backoff();
+    while (slot.load(std::memory_order_relaxed) == v && (v >> 1) > last_finalized.load() && !tx->HasWAR()) {
+        if (!backoff.Pause()) { return; }
+    }
+}
+
+/// @brief the number of deferred reads
+size_t SpectrumHints::CountDefer() {
+    return count_defer.load();
+}
+
 /// @brief spectrum initialization parameters
 /// @param workload the transaction generator
 /// @param table_partitions the number of parallel partitions to use in the hash table
@@ -243,6 +517,8 @@ Spectrum::Spectrum(Workload& workload, Statistics& statistics, size_t num_execut
     statistics{statistics},
     num_executors{num_executors},
     table{table_partitions},
+    throttle{statistics, signal, num_executors, milliseconds(FLAGS_throttle_ms)},
+    parking{num_executors * parking_depth},
     stop_latch{static_cast<ptrdiff_t>(num_executors), []{}}
 {
     LOG(INFO) << fmt::format("Spectrum(num_executors={}, table_partitions={}, evm_type={})", num_executors, table_partitions, evm_type);
@@ -254,25 +530,69 @@ Spectrum::Spectrum(Workload& workload, Statistics& statistics, size_t num_execut
 void Spectrum::Start() {
     stop_flag.store(false);
     for (size_t i = 0; i != num_executors; ++i) {
-        executors.push_back(std::thread([this]{
-            std::make_unique<SpectrumExecutor>(*this)->Run();
+        executors.push_back(std::thread([this, i]{
+            std::make_unique<SpectrumExecutor>(*this, i)->Run();
         }));
         PinRoundRobin(executors[i], i);
     }
+    throttle.Start();
 }
 
 /// @brief stop spectrum protocol
 void Spectrum::Stop() {
+    throttle.Stop();
     stop_flag.store(true);
+    signal.Notify();
     for (auto& x: executors) 	{ x.join(); }
+    statistics.JournalLocks(table.CountLocks());
+    statistics.JournalAccesses(table.CountLocalAccesses(), table.CountRemoteAccesses());
+    for (auto& [k, accesses, aborts]: HotKeys()) {
+        auto address = k.Address();
+        auto key     = k.Key();
+        statistics.JournalHotKey(fmt::format("{}:{}", to_hex(address.bytes), to_hex(key.bytes)), accesses, aborts);
+    }
+    if (hints != nullptr) { LOG(INFO) << fmt::format("SpectrumHint(deferred reads={})", hints->CountDefer()); }
+}
+
+/// @brief the hot keys of the table with their sampled accesses and aborted readers
+/// @return a list of (key, accesses, aborts)
+std::vector<std::tuple<K, size_t, size_t>> Spectrum::HotKeys() {
+    return table.HotKeys();
+}
+
+/// @brief spectrum with writer hints
+/// @param workload the transaction generator
+/// @param table_partitions the number of parallel partitions to use in the hash table
+SpectrumHint::SpectrumHint(Workload& workload, Statistics& statistics, size_t num_executors, size_t table_partitions, EVMType evm_type):
+    Spectrum(workload, statistics, num_executors, table_partitions, evm_type)
+{
+    hints = std::make_unique<SpectrumHints>();
+}
+
+/// @brief spectrum with group finalization
+/// @param workload the transaction generator
+/// @param table_partitions the number of parallel partitions to use in the hash table
+/// @param block_size the number of transaction ids in a block, groups never cross a block boundary
+SpectrumEpoch::SpectrumEpoch(Workload& workload, Statistics& statistics, size_t num_executors, size_t table_partitions, EVMType evm_type, size_t block_size):
+    Spectrum(workload, statistics, num_executors, table_partitions, evm_type)
+{
+    CHECK(block_size > 0) << "blocks hold at least one transaction";
+    this->block_size = block_size;
 }
 
 /// @brief spectrum executor
 /// @param spectrum spectrum initialization paremeters
-SpectrumExecutor::SpectrumExecutor(Spectrum& spectrum):
+/// @param executor_id the index of this executor, which the throttle admits by
+SpectrumExecutor::SpectrumExecutor(Spectrum& spectrum, size_t executor_id):
     table{spectrum.table},
     last_finalized{spectrum.last_finalized},
     stop_flag{spectrum.stop_flag},
+    signal{spectrum.signal},
+    throttle{spectrum.throttle},
+    executor_id{executor_id},
+    parking{spectrum.parking},
+    hints{spectrum.hints.get()},
+    block_size{spectrum.block_size},
     statistics{spectrum.statistics},
     workload{spectrum.workload},
     last_executed{spectrum.last_executed},
@@ -282,15 +602,28 @@ SpectrumExecutor::SpectrumExecutor(Spectrum& spectrum):
 /// @brief generate a transaction and execute it
 void SpectrumExecutor::Generate() {
     if(tx != nullptr) return;
-    tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
+    if (pool.empty()) {
+        tx = std::make_unique<T>(workload.Next(), last_executed.fetch_add(1));
+    }
+    else {
+        tx = std::move(pool.back()); pool.pop_back();
+        tx->Recycle(workload.Next(), last_executed.fetch_add(1));
+    }
     tx->start_time = steady_clock::now();
+    tx->signal = &signal;
+    tx->parking = &parking;
     tx->berun_flag.store(true);
-    tx->InstallSetStorageHandler([this](
+    if (hints != nullptr) {
+        for (auto& k: tx->predicted_set_storage) { hints->Predict(k, tx->id); }
+    }
+    tx->InstallSetStorageHandler([this, tx = tx.get()](
         const evmc::address &addr, 
         const evmc::bytes32 &key, 
         const evmc::bytes32 &value
     ) {
-        auto _key = std::make_tuple(addr, key);
+        auto _key = K(addr, key);
+        if (hints != nullptr) { hints->Predict(_key, tx->id); }
+        tx->local_index.PushPut(_key);
         tx->tuples_put.push_back({
             .key = _key, 
             .value = value, 
@@ -305,27 +638,29 @@ void SpectrumExecutor::Generate() {
             " tuples get: " << tx->tuples_get.size();
         return evmc_storage_status::EVMC_STORAGE_MODIFIED;
     });
-    tx->InstallGetStorageHandler([this](
+    tx->InstallGetStorageHandler([this, tx = tx.get()](
         const evmc::address &addr, 
         const evmc::bytes32 &key
     ) {
-        auto _key  = std::make_tuple(addr, key);
+        auto _key  = K(addr, key);
         auto value = evmc::bytes32{0};
         auto version = size_t{0};
-        for (auto& tup: tx->tuples_put | std::views::reverse) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindPut(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_put. ";
-            return tup.value;
+            return tx->tuples_put[i].value;
         }
-        for (auto& tup: tx->tuples_get) {
-            if (tup.key != _key) { continue; }
+        if (auto i = tx->local_index.FindGet(_key); i != tx->local_index.none) {
             DLOG(INFO) << "spectrum tx " << tx->id << " has key " << KeyHasher()(_key) % 1000 << " in tuples_get. ";
-            return tup.value;
+            return tx->tuples_get[i].value;
         }
         DLOG(INFO) << "tx " << tx->id << " " << 
             " read(" << tx->tuples_get.size() << ")" << 
             " key(" << KeyHasher()(_key) % 1000 << ")" << std::endl;
-        table.Get(tx.get(), _key, value, version);
+        if (!tx->Replay(_key, value, version)) {
+            if (hints != nullptr) { hints->Defer(_key, tx, last_finalized); }
+            table.Get(tx, _key, value, version);
+        }
+        tx->local_index.PushGet(_key);
         tx->tuples_get.push_back({
             .key            = _key, 
             .value          = value, 
@@ -346,11 +681,11 @@ void SpectrumExecutor::Generate() {
     statistics.JournalExecute();
     statistics.JournalOperations(tx->CountOperations());
     // commit all results if possible & necessary
-    for (auto entry: tx->tuples_put) {
-        if (tx->HasWAR()) { break; }
-        if (entry.is_committed) { continue; }
-        table.Put(tx.get(), entry.key, entry.value);
-        entry.is_committed = true;
+    if (!tx->HasWAR()) {
+        table.PutBatch(tx.get(), tx->tuples_put);
+        for (auto& entry: tx->tuples_put) {
+            if (hints != nullptr) { hints->Written(entry.key, tx->id); }
+        }
     }
 }
 
@@ -363,70 +698,138 @@ void SpectrumExecutor::ReExecute() {
     {
         auto guard = Guard{tx->rerun_keys_mu}; 
         std::swap(tx->rerun_keys, rerun_keys);
+        tx->war.store(false, std::memory_order_relaxed);
     }
     auto back_to = ~size_t{0};
     // find checkpoint
     for (auto& key: rerun_keys) {
-        for (size_t i = 0; i < tx->tuples_get.size(); ++i) {
-            if (tx->tuples_get[i].key != key) { continue; }
-            back_to = std::min(i, back_to); break;
-        }
+        back_to = std::min(tx->local_index.FindGet(key), back_to);
     }
-    // good news: we don't have to rollback, so just resume execution
+    // good news: we don't have to rollback, so just resume execution.
+    // the rerun key may belong to a released replay entry, whose writer broke us before our writes were put,
+    //   so resuming still has to go through the commit below.
     if (back_to == ~size_t{0}) {
         DLOG(INFO) << "tx " << tx->id << " do not have to rollback" << std::endl;
-        tx->Execute(); return;
+        tx->Execute();
     }
+    else {
+        Rollback(back_to, rerun_keys);
+    }
+    statistics.JournalExecute();
+    statistics.JournalOperations(tx->CountOperations());
+    // commit all results if possible & necessary
+    if (!tx->HasWAR()) {
+        table.PutBatch(tx.get(), tx->tuples_put);
+        for (auto& entry: tx->tuples_put) {
+            if (hints != nullptr) { hints->Written(entry.key, tx->id); }
+        }
+    }
+}
+
+/// @brief rollback to the checkpoint of a read and execute again from there
+/// @param back_to the index of the earliest invalidated read in tuples_get
+/// @param rerun_keys the keys invalidated by lower transactions
+void SpectrumExecutor::Rollback(size_t back_to, const std::vector<K>& rerun_keys) {
     // bad news: we have to rollback
     auto& tup = tx->tuples_get[back_to];
     tx->ApplyCheckpoint(tup.checkpoint_id);
-    for (size_t i = tup.tuples_put_len; i < tx->tuples_put.size(); ++i) {
-        if (tx->tuples_put[i].is_committed) {
-            table.RegretPut(tx.get(), tx->tuples_put[i].key);
-        }
-    }
+    table.RegretPutBatch(tx.get(), tx->tuples_put, tup.tuples_put_len);
     for (size_t i = back_to; i < tx->tuples_get.size(); ++i) {
-        table.RegretGet(tx.get(), tx->tuples_get[i].key, tx->tuples_get[i].version);
+        auto& get = tx->tuples_get[i];
+        // a read no writer has invalidated keeps its registration, and is replayed if read again
+        if (std::find(rerun_keys.begin(), rerun_keys.end(), get.key) == rerun_keys.end()) {
+            tx->replay_index.PushGet(get.key);
+            tx->replay.push_back({.key = get.key, .value = get.value, .version = get.version, .replayed = false});
+            continue;
+        }
+        table.RegretGet(tx.get(), get.key, get.version);
     }
     tx->tuples_put.resize(tup.tuples_put_len);
+    tx->local_index.TruncatePut(tup.tuples_put_len);
     tx->tuples_get.resize(back_to);
+    tx->local_index.TruncateGet(back_to);
     DLOG(INFO) << "tx " << tx->id <<
         " tuples put: " << tx->tuples_put.size() <<
         " tuples get: " << tx->tuples_get.size();
     tx->Execute();
-    statistics.JournalExecute();
-    statistics.JournalOperations(tx->CountOperations());
-    // commit all results if possible & necessary
-    for (auto entry: tx->tuples_put) {
-        if (tx->HasWAR()) { break; }
-        if (entry.is_committed) { continue; }
-        table.Put(tx.get(), entry.key, entry.value);
-        entry.is_committed = true;
+    // reads the new execution path did not perform again are no longer ours
+    for (auto& entry: tx->replay) {
+        if (!entry.replayed) { table.RegretGet(tx.get(), entry.key, entry.version); }
     }
+    tx->replay.clear();
+    tx->replay_index.Clear();
 }
 
 /// @brief finalize a spectrum transaction
 void SpectrumExecutor::Finalize() {
     DLOG(INFO) << "spectrum finalize " << tx->id;
-    last_finalized.fetch_add(1, std::memory_order_seq_cst);
-    for (auto entry: tx->tuples_get) {
-        table.ClearGet(tx.get(), entry.key, entry.version);
-    }
-    for (auto entry: tx->tuples_put) {
-        table.ClearPut(tx.get(), entry.key);
+    auto first = tx->id;
+    auto count = size_t{1};
+    Retire();
+    // in epoch mode, every lower transaction is final, so parked ones right behind us cannot be invalidated anymore.
+    // finalize them together up to the end of the block, the window keeps their parking slots unambiguous.
+    auto block_end = block_size == 0 ? first : (first - 1) / block_size * block_size + block_size;
+    while (first + count <= block_end && count < parking.Capacity()) {
+        tx = parking.Take(first + count);
+        if (tx == nullptr || tx->HasWAR()) { break; }
+        DLOG(INFO) << "spectrum finalize " << tx->id << " with " << first;
+        Retire(); ++count;
     }
+    last_finalized.fetch_add(count, std::memory_order_seq_cst);
+    signal.Notify();
+    if (retired.size() >= retire_batch) { Reclaim(); }
+}
+
+/// @brief journal a finalized transaction and keep it until reclamation
+void SpectrumExecutor::Retire() {
     auto latency = duration_cast<microseconds>(steady_clock::now() - tx->start_time).count();
     statistics.JournalCommit(latency);
     statistics.JournalMemory(tx->mm_count);
-    tx = nullptr;
+    // readers still hold raw pointers to this transaction, so we keep it until reclamation
+    retired.push_back(std::move(tx));
+}
+
+/// @brief clear retired transactions from the table, then keep them for reuse or free them
+void SpectrumExecutor::Reclaim() {
+    if (retired.empty()) { return; }
+    DLOG(INFO) << "spectrum reclaim " << retired.size() << " transactions";
+    table.ClearBatch(retired);
+    // nothing in the table points to them anymore, so they can take a new id
+    for (auto& _tx: retired) {
+        if (pool.size() >= FLAGS_transaction_pool) { break; }
+        pool.push_back(std::move(_tx));
+    }
+    retired.clear();
 }
 
 /// @brief start an executor
 void SpectrumExecutor::Run() {
+    auto start_time = steady_clock::now();
     while (!stop_flag.load()) {
-        // first generate a transaction
-        Generate();
-        if (tx->HasWAR()) {
+        if (tx == nullptr && !throttle.Admit(executor_id)) {
+            // the throttle runs fewer executors for now. we hold no transaction, parked ones are picked up by others.
+            Reclaim();
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{ return stop_flag.load() || throttle.Admit(executor_id); });
+            wait_time += steady_clock::now() - wait_start;
+            continue;
+        }
+        auto frontier = last_finalized.load() + 1;
+        // pick up parked work first, the finalize frontier before transactions that have to re-execute
+        if (tx == nullptr) { tx = parking.Take(frontier); }
+        if (tx == nullptr) { tx = parking.TakeFlagged(frontier); }
+        // otherwise start a new transaction, as long as it can be parked afterwards
+        if (tx == nullptr && last_executed.load() < frontier + parking.Capacity()) { Generate(); }
+        if (tx == nullptr) {
+            // the window is full, and nothing parked can make progress yet
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{
+                return stop_flag.load() || last_finalized.load() + 1 != frontier ||
+                    parking.Parked(frontier) || parking.HasFlagged();
+            });
+            wait_time += steady_clock::now() - wait_start;
+        }
+        else if (tx->HasWAR()) {
             // if there are some re-run keys, re-execute to obtain the correct result
             ReExecute();
         }
@@ -435,7 +838,20 @@ void SpectrumExecutor::Run() {
             // then i can final commit and do another transaction. 
             Finalize();
         }
+        else if (parking.Park(tx, last_finalized.load() + 1)) {
+            // a parked transaction may be the frontier by now, let the others know.
+            // a re-run request racing with parking may lose its flag, then the frontier picks it up.
+            signal.Notify();
+        }
+        else {
+            // nothing to do until the previous transaction finalizes or this one has to re-execute
+            auto wait_start = steady_clock::now();
+            signal.Wait([&]{ return stop_flag.load() || last_finalized.load() + 1 == tx->id || tx->HasWAR(); });
+            wait_time += steady_clock::now() - wait_start;
+        }
     }
+    Reclaim();
+    statistics.JournalExecutorTime(wait_time, steady_clock::now() - start_time);
     stop_latch.arrive_and_wait();
 }
 
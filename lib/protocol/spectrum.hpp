@@ -2,7 +2,11 @@
 #include <spectrum/common/lock-util.hpp>
 #include <spectrum/protocol/abstraction.hpp>
 #include <spectrum/transaction/evm-hash.hpp>
-#include <list>
+#include <spectrum/common/version-list.hpp>
+#include <spectrum/common/reader-set.hpp>
+#include <spectrum/common/local-index.hpp>
+#include <spectrum/common/wait-util.hpp>
+#include <spectrum/common/throttle.hpp>
 #include <atomic>
 #include <tuple>
 #include <vector>
@@ -13,7 +17,7 @@
 namespace spectrum {
 
 // some shorthands to prevent prohibitively long names
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 #define V SpectrumVersionList
 #define T SpectrumTransaction
 
@@ -33,47 +37,129 @@ struct SpectrumGetTuple {
     size_t          checkpoint_id;
 };
 
+struct SpectrumReplayTuple {
+    K               key;
+    evmc::bytes32   value;
+    size_t          version;
+    bool            replayed;
+};
+
 struct SpectrumTransaction: public Transaction {
     size_t      id;
     size_t      should_wait{0};
     SpinLock            rerun_keys_mu;
     std::vector<K>      rerun_keys;
+    // set together with rerun_keys under rerun_keys_mu, but read without it
+    std::atomic<bool>   war{false};
     std::atomic<bool>   berun_flag{false};
     time_point<steady_clock>            start_time;
     std::vector<SpectrumGetTuple>       tuples_get{};
     std::vector<SpectrumPutTuple>       tuples_put{};
+    LocalIndex<K, KeyHasher>            local_index;
+    // reads that survived a rollback, still registered in the table and served again without it
+    std::vector<SpectrumReplayTuple>    replay{};
+    LocalIndex<K, KeyHasher>            replay_index;
+    // notified when this transaction has to re-execute
+    Signal*     signal{nullptr};
+    // flagged when this transaction has to re-execute, in case it is parked
+    ParkingRing<SpectrumTransaction>*   parking{nullptr};
     SpectrumTransaction(Transaction&& inner, size_t id);
+    void Recycle(Transaction&& inner, size_t id);
     bool HasWAR();
     void SetWAR(const K& key, size_t cause_id);
+    bool Replay(const K& key, evmc::bytes32& value, size_t& version);
 };
 
 struct SpectrumEntry {
     evmc::bytes32   value;
     size_t          version;
     // we store raw pointers here because when a transaction is destructed, it always removes itself from table. 
-    std::unordered_set<T*>  readers;
+    ReaderSet<T>            readers;
 };
 
+struct SpectrumHotEntry;
+
 struct SpectrumVersionList {
     T*          tx = nullptr;
-    std::list<SpectrumEntry> entries;
+    VersionVector<SpectrumEntry> entries;
     // readers that read default value
-    std::unordered_set<T*>  readers_default;
+    ReaderSet<T>            readers_default;
+    // sampled accesses and aborted readers, halved every window, which decide if this key is moved to the hot index
+    size_t                  accesses{0};
+    size_t                  aborts{0};
+    // the hot entry this key was moved to, if any
+    SpectrumHotEntry*       hot{nullptr};
+    using allocator_type = VersionVector<SpectrumEntry>::allocator_type;
+    SpectrumVersionList(const allocator_type& alloc = {}): entries{alloc} {}
+};
+
+// a contended key moved out of its partition, with its own lock and pre-sized versions
+struct alignas(64) SpectrumHotEntry {
+    SpinLock    mu;
+    K           key;
+    V           value;
 };
 
 struct SpectrumTable: private Table<K, V, KeyHasher> {
 
+    private:
+    static constexpr size_t hot_capacity  = 1024;
+    static constexpr size_t hot_probe     = 32;
+    static constexpr size_t hot_threshold = 64;
+    static constexpr size_t hot_sample    = 16;
+    static constexpr size_t hot_versions  = 16;
+    static constexpr size_t hot_window    = 4096;
+    // lock-free index of hot entries, slots are only filled once
+    std::unique_ptr<std::atomic<SpectrumHotEntry*>[]> hot_index;
+    // the number of promoted keys, lookups skip the hot index while it is zero
+    std::atomic<size_t> hot_count{0};
+    SpectrumHotEntry* FindHot(const K& k);
+    void Promote(const K& k, V& _v);
+    template<typename F>
+    void Access(const K& k, F&& vmap);
+    template<typename F>
+    void AccessLocked(const K& k, V& _v, F&& vmap);
+    template<typename I, typename P, typename F>
+    void AccessBatch(std::vector<I>& items, P&& key, F&& vmap);
+
+    public:
     SpectrumTable(size_t partitions);
+    ~SpectrumTable();
     void Get(T* tx, const K& k, evmc::bytes32& v, size_t& version);
     void Put(T* tx, const K& k, const evmc::bytes32& v);
+    void PutBatch(T* tx, std::vector<SpectrumPutTuple>& tuples_put);
     void RegretGet(T* tx, const K& k, size_t version);
     void RegretPut(T* tx, const K& k);
+    void RegretPutBatch(T* tx, std::vector<SpectrumPutTuple>& tuples_put, size_t from);
     void ClearGet(T* tx, const K& k, size_t version);
     void ClearPut(T* tx, const K& k);
+    void ClearBatch(std::vector<std::unique_ptr<T>>& txs);
+    using Table::CountLocks;
+    using Table::CountLocalAccesses;
+    using Table::CountRemoteAccesses;
+    std::vector<std::tuple<K, size_t, size_t>> HotKeys();
+
+};
+
+/// @brief a lossy table of the latest predicted writer of each key, hashed into fixed slots
+class SpectrumHints {
+
+    static constexpr size_t capacity = 1 << 16;
+
+    private:
+    // writer id << 1, with the low bit set once its write is visible in the table
+    std::unique_ptr<std::atomic<size_t>[]>  slots;
+    std::atomic<size_t>                     count_defer{0};
+
+    public:
+    SpectrumHints();
+    void    Predict(const K& k, size_t id);
+    void    Written(const K& k, size_t id);
+    void    Defer(const K& k, T* tx, std::atomic<size_t>& last_finalized);
+    size_t  CountDefer();
 
 };
 
-using SpectrumQueue = LockPriorityQueue<T>;
 class SpectrumExecutor;
 
 class Spectrum: public Protocol {
@@ -86,14 +172,26 @@ class Spectrum: public Protocol {
     std::atomic<size_t> last_executed{1};
     std::atomic<size_t> last_finalized{0};
     std::atomic<bool>   stop_flag{false};
+    Signal              signal;
+    Throttle            throttle;
+    // executed transactions waiting to finalize, so their executors can start new ones
+    ParkingRing<T>      parking;
     std::vector<std::thread>    executors{};
     std::barrier<std::function<void()>>            stop_latch;
     friend class SpectrumExecutor;
+    static constexpr size_t parking_depth = 4;
+
+    protected:
+    // only set in hint mode, see SpectrumHint
+    std::unique_ptr<SpectrumHints>  hints{nullptr};
+    // only set in epoch mode, see SpectrumEpoch
+    size_t                          block_size{0};
 
     public:
     Spectrum(Workload& workload, Statistics& statistics, size_t num_executors, size_t table_partitions, EVMType evm_type);
     void Start() override;
     void Stop() override;
+    std::vector<std::tuple<K, size_t, size_t>> HotKeys();
 
 };
 
@@ -106,19 +204,49 @@ class SpectrumExecutor {
     std::atomic<size_t>&    last_executed;
     std::atomic<size_t>&    last_finalized;
     std::atomic<bool>&      stop_flag;
-    SpectrumQueue           queue;
+    Signal&                 signal;
+    Throttle&               throttle;
+    size_t                  executor_id;
+    ParkingRing<T>&         parking;
+    SpectrumHints*          hints;
+    size_t                  block_size;
     std::unique_ptr<T>      tx{nullptr};
+    nanoseconds             wait_time{0};
+    // finalized transactions whose reads and writes are not yet cleared from the table
+    std::vector<std::unique_ptr<T>>     retired{};
+    // reclaimed transactions kept for reuse, so generating one does not allocate a vm again
+    std::vector<std::unique_ptr<T>>     pool{};
     std::barrier<std::function<void()>>&           stop_latch;
+    static constexpr size_t retire_batch = 32;
 
     public:
-    SpectrumExecutor(Spectrum& spectrum);
+    SpectrumExecutor(Spectrum& spectrum, size_t executor_id);
     void Finalize();
+    void Retire();
+    void Reclaim();
     void Generate();
     void ReExecute();
+    void Rollback(size_t back_to, const std::vector<K>& rerun_keys);
     void Run();
 
 };
 
+/// @brief spectrum, deferring reads of keys that a lower unfinalized transaction is predicted to write
+class SpectrumHint: public Spectrum {
+
+    public:
+    SpectrumHint(Workload& workload, Statistics& statistics, size_t num_executors, size_t table_partitions, EVMType evm_type);
+
+};
+
+/// @brief spectrum, finalizing ready transactions in groups that never cross a block boundary
+class SpectrumEpoch: public Spectrum {
+
+    public:
+    SpectrumEpoch(Workload& workload, Statistics& statistics, size_t num_executors, size_t table_partitions, EVMType evm_type, size_t block_size);
+
+};
+
 #undef T
 #undef V
 #undef K
@@ -23,4 +23,63 @@ TEST(Spectrum, JustRunYCSB) {
     statistics.Print();
 }
 
-}
\ No newline at end of file
+TEST(Spectrum, HotKeysUnderSkew) {
+    google::InstallPrefixFormatter(PrefixFormatter);
+    auto statistics = Statistics();
+    auto workload = YCSB(11, 1.5);
+    auto protocol = Spectrum(workload, statistics, 8, 32, EVMType::COPYONWRITE);
+    protocol.Start();
+    std::this_thread::sleep_for(100ms);
+    protocol.Stop();
+    ASSERT_FALSE(protocol.HotKeys().empty());
+}
+
+TEST(SpectrumHint, JustRunYCSBUnderSkew) {
+    google::InstallPrefixFormatter(PrefixFormatter);
+    auto statistics = Statistics();
+    auto workload = YCSB(11, 1.5);
+    auto protocol = SpectrumHint(workload, statistics, 8, 32, EVMType::COPYONWRITE);
+    protocol.Start();
+    std::this_thread::sleep_for(100ms);
+    protocol.Stop();
+    std::cerr << statistics.Print();
+}
+
+TEST(SpectrumEpoch, JustRunYCSB) {
+    google::InstallPrefixFormatter(PrefixFormatter);
+    auto statistics = Statistics();
+    auto workload = YCSB(11, 1.0);
+    auto protocol = SpectrumEpoch(workload, statistics, 8, 32, EVMType::COPYONWRITE, 16);
+    protocol.Start();
+    std::this_thread::sleep_for(100ms);
+    protocol.Stop();
+    std::cerr << statistics.Print();
+}
+
+
+TEST(SpectrumTable, RollbackKeepsEarlierWrite) {
+    auto code  = std::vector<uint8_t>{0x00};
+    auto input = std::vector<uint8_t>{0x00};
+    auto table = SpectrumTable(4);
+    auto tx2   = SpectrumTransaction(TX(code, input), 2);
+    auto tx3   = SpectrumTransaction(TX(code, input), 3);
+    auto k     = StorageKey(evmc::address{0x1}, evmc::bytes32{0x1});
+    // tx2 writes k, reads another key (its checkpoint), writes k again, and commits both writes
+    tx2.tuples_put.push_back({.key = k, .value = evmc::bytes32{1}, .is_committed = false});
+    auto checkpoint_len = tx2.tuples_put.size();
+    tx2.tuples_put.push_back({.key = k, .value = evmc::bytes32{2}, .is_committed = false});
+    table.PutBatch(&tx2, tx2.tuples_put);
+    // rolling back to the read drops the second write, the re-execution takes another path and writes nothing more
+    table.RegretPutBatch(&tx2, tx2.tuples_put, checkpoint_len);
+    tx2.tuples_put.resize(checkpoint_len);
+    ASSERT_FALSE(tx2.tuples_put[0].is_committed);
+    table.PutBatch(&tx2, tx2.tuples_put);
+    // the write before the checkpoint is visible again
+    auto value   = evmc::bytes32{0};
+    auto version = size_t{0};
+    table.Get(&tx3, k, value, version);
+    ASSERT_EQ(version, 2);
+    ASSERT_EQ(value, evmc::bytes32{1});
+}
+
+}
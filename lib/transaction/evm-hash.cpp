@@ -1,5 +1,6 @@
 #include <spectrum/transaction/evm-hash.hpp>
 #include <cstddef>
+#include <cstring>
 #include <functional>
 #include <tuple>
 
@@ -8,22 +9,70 @@ namespace spectrum
 
 #define K std::tuple<evmc::address, evmc::bytes32>
 
+/// @brief fold the 128 bit product of two words, the mixing step of wyhash
+static inline uint64_t Mum(uint64_t a, uint64_t b) {
+    auto r = (unsigned __int128) a * b;
+    return uint64_t(r) ^ uint64_t(r >> 64);
+}
+
+/// @brief hash packed key words, wyhash over 7 words
+/// @param words the packed key
+/// @return the hash value
+static inline uint64_t HashWords(const uint64_t (&words)[7]) {
+    constexpr uint64_t p0 = 0xa0761d6478bd642full;
+    constexpr uint64_t p1 = 0xe7037ed1a0b428dbull;
+    constexpr uint64_t p2 = 0x8ebc6af09c88c6e3ull;
+    constexpr uint64_t p3 = 0x589965cc75374cc3ull;
+    auto a = Mum(words[0] ^ p1, words[1] ^ p0);
+    auto b = Mum(words[2] ^ p2, words[3] ^ p0);
+    auto c = Mum(words[4] ^ p3, words[5] ^ p0);
+    return Mum(Mum(a ^ b ^ p1, c ^ words[6] ^ p2), p1 ^ (7 * 8));
+}
+
+/// @brief the zero key
+StorageKey::StorageKey():
+    words{},
+    hash{HashWords(words)}
+{}
+
+/// @brief pack a storage key and compute its hash
+/// @param address the contract address
+/// @param key the storage slot
+StorageKey::StorageKey(const evmc::address& address, const evmc::bytes32& key):
+    words{}
+{
+    std::memcpy((char*) words, address.bytes, sizeof(address.bytes));
+    std::memcpy((char*) words + sizeof(evmc_address::bytes), key.bytes, sizeof(key.bytes));
+    hash = HashWords(words);
+}
+
+/// @brief pack a storage key from a tuple
+/// @param key the tuple of address and storage slot
+StorageKey::StorageKey(const K& key):
+    StorageKey(std::get<0>(key), std::get<1>(key))
+{}
+
+/// @brief unpack the contract address
+evmc::address StorageKey::Address() const {
+    auto address = evmc::address{};
+    std::memcpy(address.bytes, (const char*) words, sizeof(address.bytes));
+    return address;
+}
+
+/// @brief unpack the storage slot
+evmc::bytes32 StorageKey::Key() const {
+    auto key = evmc::bytes32{};
+    std::memcpy(key.bytes, (const char*) words + sizeof(evmc_address::bytes), sizeof(key.bytes));
+    return key;
+}
+
 /// @brief the hashing method
 /// @param key the hashed key
 /// @return the hash value
-size_t KeyHasher::operator()(const K& key) const { 
-    auto addr = std::get<0>(key);
-    auto keyx = std::get<1>(key);
-    size_t h = 0;
-    for (auto x: addr.bytes) {
-        h ^= std::hash<int>{}(x)  + 0x9e3779b9 + (h << 6) + (h >> 2);
-    }
-    for (auto x: keyx.bytes) {
-        h ^= std::hash<int>{}(x)  + 0x9e3779b9 + (h << 6) + (h >> 2);
-    }
-    return h;
+size_t KeyHasher::operator()(const K& key) const {
+    return StorageKey(key).hash;
 }
 
 #undef K
 
-} // namespace spectrum
\ No newline at end of file
+} // namespace spectrum
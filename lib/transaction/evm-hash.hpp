@@ -1,16 +1,35 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
+#include <tuple>
 #include <evmc/evmc.hpp>
 
 namespace spectrum {
 
 #define K std::tuple<evmc::address, evmc::bytes32>
 
+/// @brief a storage slot key, packed into one cache line with its hash precomputed
+struct alignas(64) StorageKey {
+    // 20 bytes address, 32 bytes key, 4 bytes zero padding
+    uint64_t    words[7];
+    uint64_t    hash;
+    StorageKey();
+    StorageKey(const evmc::address& address, const evmc::bytes32& key);
+    StorageKey(const K& key);
+    evmc::address Address() const;
+    evmc::bytes32 Key() const;
+    bool operator==(const StorageKey& other) const {
+        auto diff = hash ^ other.hash;
+        for (size_t i = 0; i < 7; ++i) { diff |= words[i] ^ other.words[i]; }
+        return diff == 0;
+    }
+};
+
 struct KeyHasher {
+    size_t operator()(const StorageKey& key) const { return key.hash; }
     size_t operator()(const K& key) const;
 };
 
 #undef K
 
 } // namespace spectrum
-
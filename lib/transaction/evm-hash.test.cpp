@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include <spectrum/transaction/evm-hash.hpp>
+#include <unordered_set>
+#include <tuple>
+
+namespace {
+
+using namespace spectrum;
+
+TEST(StorageKey, PackAndCompare) {
+    auto k0 = StorageKey(evmc::address{0x1}, evmc::bytes32{0x2});
+    auto k1 = StorageKey(std::make_tuple(evmc::address{0x1}, evmc::bytes32{0x2}));
+    auto k2 = StorageKey(evmc::address{0x2}, evmc::bytes32{0x1});
+    ASSERT_EQ(sizeof(StorageKey), 64);
+    ASSERT_TRUE(k0 == k1);
+    ASSERT_FALSE(k0 == k2);
+    ASSERT_EQ(KeyHasher()(k0), KeyHasher()(k1));
+    ASSERT_EQ(KeyHasher()(k0), KeyHasher()(std::make_tuple(evmc::address{0x1}, evmc::bytes32{0x2})));
+    ASSERT_TRUE(k0.Address() == evmc::address{0x1});
+    ASSERT_TRUE(k0.Key() == evmc::bytes32{0x2});
+}
+
+TEST(StorageKey, HashSpread) {
+    // sequential slots should not collide in the low bits used for partitioning
+    auto buckets = std::unordered_set<size_t>();
+    for (size_t i = 0; i < 1024; ++i) {
+        buckets.insert(KeyHasher()(StorageKey(evmc::address{0x1}, evmc::bytes32{i})) % 4096);
+    }
+    ASSERT_GT(buckets.size(), 800);
+}
+
+}
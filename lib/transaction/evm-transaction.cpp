@@ -15,18 +15,45 @@
 #include <fmt/core.h>
 #include <stdexcept>
 
+DEFINE_bool(warm_analysis, false, "analyze contracts when the workload is constructed, instead of in the first transaction running them");
+DEFINE_bool(threaded_code, false, "run COPYONWRITE transactions as pre-translated threaded code instead of the opcode switch");
+
 namespace spectrum {
 
 /// @brief create a EVMType enum value from given string
-/// @param s BASIC | STRAWMAN | COPYONWRITE
+/// @param s BASIC | STRAWMAN | COPYONWRITE | INCREMENTAL
 /// @return the indicated EVMType
 EVMType ParseEVMType(std::basic_string_view<char> s) {
     if (s == "BASIC")       { return EVMType::BASIC; }
     if (s == "STRAWMAN")    { return EVMType::STRAWMAN; }
     if (s == "COPYONWRITE") { return EVMType::COPYONWRITE; }
+    if (s == "INCREMENTAL") { return EVMType::INCREMENTAL; }
     throw std::runtime_error(std::string{fmt::format("unknown evmtype {}", s)});
 }
 
+/// @brief put the analysis of a contract into the shared caches of both interpreters
+/// @param code the contract code, as passed to Transaction
+void WarmCodeAnalysis(std::span<uint8_t> code) {
+    // transactions run the code without its last byte, the cache key has to match
+    auto container = evmone::bytes_view{&code[0], code.size() - 1};
+    evmone::baseline::analyze_shared(EVMC_SHANGHAI, container);
+    evmcow::baseline::analyze_shared(EVMC_SHANGHAI, container);
+}
+
+/// @brief let both interpreters find the analysis of a contract by its address
+/// @param code the contract code, as passed to Transaction, kept unchanged at its address until the process exits
+void PinCode(std::span<uint8_t> code) {
+    auto container = evmone::bytes_view{&code[0], code.size() - 1};
+    evmone::baseline::pin_code(EVMC_SHANGHAI, container);
+    evmcow::baseline::pin_code(EVMC_SHANGHAI, container);
+}
+
+/// @brief the time both interpreters spent looking up and analyzing code so far
+/// @return the time in nanoseconds
+size_t CountAnalysisTime() {
+    return evmone::baseline::analysis_stats().nanoseconds + evmcow::baseline::analysis_stats().nanoseconds;
+}
+
 // constructor for transaction object
 Transaction::Transaction(
     EVMType evm_type, 
@@ -37,7 +64,7 @@ Transaction::Transaction(
 ):
     input(input.begin(), input.end()),
     evm_type{evm_type},
-    vm{(evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN) ? 
+    vm{(evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN || evm_type == EVMType::INCREMENTAL) ? 
         std::variant<evmone::VM, evmcow::VM>(evmone::VM()) : 
         std::variant<evmone::VM, evmcow::VM>(evmcow::VM())
     },
@@ -59,9 +86,67 @@ Transaction::Transaction(
         .input_size = this->input.size(),
         .value{0},
     };
+    if (auto _vm = std::get_if<evmcow::VM>(&vm)) { _vm->threaded = FLAGS_threaded_code; }
     mm_count += 32 * 1024;
 }
 
+/// @brief take over the message of a fresh transaction, keeping this transaction's vm storage
+/// @param other the fresh transaction, which is left empty
+void Transaction::Recycle(Transaction&& other) {
+    std::swap(input, other.input);
+    std::swap(predicted_get_storage, other.predicted_get_storage);
+    std::swap(predicted_set_storage, other.predicted_set_storage);
+    message = other.message;
+    message.input_data = &input[0];
+    message.input_size = input.size();
+    mm_count = 32 * 1024;
+    op_count = 0;
+    auto same_code = code.data() == other.code.data() && code.size() == other.code.size();
+    code = other.code;
+    if (evm_type != other.evm_type) {
+        evm_type = other.evm_type;
+        if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN || evm_type == EVMType::INCREMENTAL) { vm.emplace<evmone::VM>(); }
+        else { vm.emplace<evmcow::VM>().threaded = FLAGS_threaded_code; }
+        return;
+    }
+    // the execution state, its stack space and memory, and the checkpoint vector are kept.
+    // code analysis is only looked up again when the code changes.
+    if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN || evm_type == EVMType::INCREMENTAL) {
+        auto& _vm = std::get<evmone::VM>(vm);
+        auto container = evmone::bytes_view{&code[0], code.size() - 1};
+        _vm.op_count = 0;
+        _vm.checkpoints.clear();
+        _vm.snapshots.clear();
+        _vm.arena.clear();
+        if (!same_code) { _vm.analysis.reset(); }
+        if (_vm.state == std::nullopt) { return; }
+        if (_vm.analysis == nullptr) {
+            _vm.analysis = evmone::baseline::analyze_shared(EVMC_SHANGHAI, container);
+        }
+        _vm.state.value()->reset(
+            message, EVMC_SHANGHAI, host.get_interface(), host.to_context(),
+            container, _vm.analysis->eof_header.get_data(container)
+        );
+        return;
+    }
+    if (evm_type == EVMType::COPYONWRITE) {
+        auto& _vm = std::get<evmcow::VM>(vm);
+        auto container = evmcow::bytes_view{&code[0], code.size() - 1};
+        _vm.op_count = 0;
+        _vm.checkpoints.clear();
+        if (!same_code) { _vm.analysis.reset(); }
+        if (_vm.state == std::nullopt) { return; }
+        if (_vm.analysis == nullptr) {
+            _vm.analysis = evmcow::baseline::analyze_shared(EVMC_SHANGHAI, container);
+        }
+        _vm.state.value()->reset(
+            message, EVMC_SHANGHAI, host.get_interface(), host.to_context(),
+            container, _vm.analysis->eof_header.get_data(container)
+        );
+        return;
+    }
+}
+
 // update set_storage handler
 void Transaction::InstallSetStorageHandler(spectrum::SetStorage&& handler) {
     host.set_storage_inner = handler;
@@ -87,12 +172,17 @@ size_t Transaction::MakeCheckpoint() {
         _vm.checkpoints.push_back(std::make_unique<evmone::ExecutionState>(*_vm.state.value()));
         return _vm.checkpoints.size() - 1;
     }
+    if (evm_type == EVMType::INCREMENTAL) {
+        auto& _vm = std::get<evmone::VM>(vm);
+        auto arena_size = _vm.arena.size();
+        _vm.snapshots.push_back(_vm.state.value()->save_snapshot(_vm.arena));
+        mm_count += _vm.arena.size() - arena_size;
+        return _vm.snapshots.size() - 1;
+    }
     if (evm_type == EVMType::COPYONWRITE) {
         auto& _vm = std::get<evmcow::VM>(vm);
-        for (auto ownership: _vm.state.value()->stack_top.ownership) {
-            if (!ownership) continue;
-            mm_count += evmcow::SLICE * 32;
-        }
+        mm_count += _vm.state.value()->stack_top.owned() * evmcow::SLICE * 32;
+        mm_count += _vm.state.value()->memory.saved();
         _vm.checkpoints.push_back(_vm.state.value()->save_checkpoint());
         return _vm.checkpoints.size() - 1;
     }
@@ -114,6 +204,12 @@ void Transaction::ApplyCheckpoint(size_t checkpoint_id) {
         _vm.checkpoints.resize(checkpoint_id);
         return;
     }
+    if (evm_type == EVMType::INCREMENTAL) {
+        auto& _vm = std::get<evmone::VM>(vm);
+        _vm.state.value()->load_snapshot(_vm.snapshots[checkpoint_id], _vm.arena);
+        _vm.snapshots.resize(checkpoint_id);
+        return;
+    }
     if (evm_type == EVMType::COPYONWRITE) {
         auto& _vm = std::get<evmcow::VM>(vm);
         _vm.state.value()->load_checkpoint(_vm.checkpoints[checkpoint_id]);
@@ -126,7 +222,7 @@ void Transaction::ApplyCheckpoint(size_t checkpoint_id) {
 void Transaction::Break() {
     DLOG(INFO) << "transaction break" << std::endl;
     // can only be called inside execution
-    if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN) {
+    if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN || evm_type == EVMType::INCREMENTAL) {
         auto& _vm = std::get<evmone::VM>(vm);
         _vm.state->get()->will_break = true;
     }
@@ -139,7 +235,7 @@ void Transaction::Break() {
 /// @brief execute a transaction
 void Transaction::Execute() {
     DLOG(INFO) << "transaction execute" << std::endl;
-    if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN) {
+    if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN || evm_type == EVMType::INCREMENTAL) {
         auto& _vm = std::get<evmone::VM>(vm);
         auto host_interface = &host.get_interface();
         auto host_context   = host.to_context();
@@ -202,7 +298,7 @@ void Transaction::Analyze(Prediction& prediction) {
 
 /// @brief flush operations from inner vm to transaction, useful when vm is exchanged
 void Transaction::FlushOperations() {
-    if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN) {
+    if (evm_type == EVMType::BASIC || evm_type == EVMType::STRAWMAN || evm_type == EVMType::INCREMENTAL) {
         auto& _vm = std::get<evmone::VM>(vm);
         op_count += _vm.op_count;
         _vm.op_count = 0; return;
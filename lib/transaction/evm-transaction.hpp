@@ -8,20 +8,30 @@
 #include <evmc/evmc.h>
 #include <evmc/evmc.hpp>
 #include <fmt/core.h>
+#include <gflags/gflags.h>
 #include <span>
 #include <stdexcept>
 #include <unordered_set>
 #include <variant>
 #include <vector>
 
+DECLARE_bool(warm_analysis);
+DECLARE_bool(threaded_code);
+
 namespace spectrum {
 
-#define K std::tuple<evmc::address, evmc::bytes32>
+#define K StorageKey
 
-enum EVMType { BASIC = 0, STRAWMAN = 1, COPYONWRITE = 2 };
+enum EVMType { BASIC = 0, STRAWMAN = 1, COPYONWRITE = 2, INCREMENTAL = 3 };
 
 EVMType ParseEVMType(std::basic_string_view<char> s);
 
+void WarmCodeAnalysis(std::span<uint8_t> code);
+
+void PinCode(std::span<uint8_t> code);
+
+size_t CountAnalysisTime();
+
 /// @brief the evmc_result that automatically destructs itself
 struct Result : public evmc_result {
 
@@ -35,7 +45,7 @@ struct Prediction {
     std::vector<K> put; // the write keys
 };
 
-/// @brief the base class for evm transactions, providing COPYONWRITE, BASIC, STRAWMAN mode for mini-checkpointing
+/// @brief the base class for evm transactions, providing COPYONWRITE, BASIC, STRAWMAN, INCREMENTAL mode for mini-checkpointing
 class Transaction {
 
     private:
@@ -54,6 +64,7 @@ class Transaction {
     std::unordered_set<K, KeyHasher>  predicted_set_storage;
     Transaction(EVMType evm_type, evmc::address from, evmc::address to,
                 std::span<uint8_t> code, std::span<uint8_t> input);
+    void Recycle(Transaction&& other);
     void InstallSetStorageHandler(spectrum::SetStorage &&handler);
     void InstallGetStorageHandler(spectrum::GetStorage &&handler);
     void Analyze(Prediction& prediction);
@@ -78,7 +89,7 @@ template <> struct fmt::formatter<spectrum::EVMType> {
     template <typename FormatContext>
     auto format(spectrum::EVMType const &value, FormatContext &ctx) const {
         #define OPT(X) case spectrum::EVMType::X: return fmt::format_to(ctx.out(), "{}", #X);
-        switch (value) { OPT(BASIC) OPT(STRAWMAN) OPT(COPYONWRITE) }
+        switch (value) { OPT(BASIC) OPT(STRAWMAN) OPT(COPYONWRITE) OPT(INCREMENTAL) }
         #undef OPT
         throw std::runtime_error("unreachable");
     }
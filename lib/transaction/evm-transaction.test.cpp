@@ -203,6 +203,159 @@ TEST(Transaction, RunCopyOnWrite) {
     }
 }
 
+TEST(Transaction, RecycleCopyOnWrite) {
+    using Writes = std::vector<std::tuple<evmc::bytes32, evmc::bytes32>>;
+    auto code = CODE;
+    auto input_a = spectrum::from_hex(std::string{"1e010439"} + to_string(10)).value();
+    auto input_b = spectrum::from_hex(std::string{"bb27eb2c"} + to_string(3) + to_string(7)).value();
+    // run a transaction with checkpoints against an empty table, logging its writes
+    auto run = [&](spectrum::Transaction& transaction, Writes& writes) {
+        auto table = MockTable();
+        transaction.InstallGetStorageHandler([&](auto& addr, auto& key) {
+            transaction.MakeCheckpoint();
+            return table.GetStorage(addr, key);
+        });
+        transaction.InstallSetStorageHandler([&](auto& addr, auto& key, auto& value) {
+            writes.push_back({key, value});
+            table.SetStorage(addr, key, value);
+            return evmc_storage_status::EVMC_STORAGE_ASSIGNED;
+        });
+        transaction.Execute();
+    };
+    auto fresh = spectrum::Transaction(spectrum::EVMType::COPYONWRITE, evmc::address{0x1}, evmc::address{0x2}, std::span{code}, std::span{input_b});
+    auto fresh_writes = Writes();
+    run(fresh, fresh_writes);
+    // a recycled transaction keeps its vm, but must not remember anything of its last message
+    auto recycled = spectrum::Transaction(spectrum::EVMType::COPYONWRITE, evmc::address{0x1}, evmc::address{0x2}, std::span{code}, std::span{input_a});
+    auto recycled_writes = Writes();
+    run(recycled, recycled_writes);
+    recycled_writes.clear();
+    recycled.Recycle(spectrum::Transaction(spectrum::EVMType::COPYONWRITE, evmc::address{0x1}, evmc::address{0x2}, std::span{code}, std::span{input_b}));
+    run(recycled, recycled_writes);
+    ASSERT_EQ(fresh_writes, recycled_writes);
+}
+
+TEST(Transaction, ShareCodeAnalysis) {
+    auto code  = CODE;
+    auto other = std::vector<uint8_t>(code.begin(), code.begin() + code.size() / 2);
+    auto container = evmone::bytes_view{&code[0], code.size() - 1};
+    auto a = evmone::baseline::analyze_shared(EVMC_SHANGHAI, container);
+    auto b = evmone::baseline::analyze_shared(EVMC_SHANGHAI, evmone::bytes_view{&code[0], code.size() - 1});
+    auto c = evmone::baseline::analyze_shared(EVMC_SHANGHAI, evmone::bytes_view{&other[0], other.size()});
+    ASSERT_EQ(a.get(), b.get());
+    ASSERT_NE(a.get(), c.get());
+    // a copy of the same code at another address hits the cache as well
+    auto copy = code;
+    auto d = evmcow::baseline::analyze_shared(EVMC_SHANGHAI, evmcow::bytes_view{&code[0], code.size() - 1});
+    auto e = evmcow::baseline::analyze_shared(EVMC_SHANGHAI, evmcow::bytes_view{&copy[0], copy.size() - 1});
+    ASSERT_EQ(d.get(), e.get());
+}
+
+TEST(Transaction, PinnedCodeAnalysis) {
+    // pinned code has to stay at its address for the rest of the process
+    static auto code = CODE;
+    auto container = evmone::bytes_view{&code[0], code.size() - 1};
+    evmone::baseline::pin_code(EVMC_SHANGHAI, container);
+    auto a = evmone::baseline::analyze_shared(EVMC_SHANGHAI, container);
+    auto hits = evmone::baseline::analysis_stats().hits;
+    auto b = evmone::baseline::analyze_shared(EVMC_SHANGHAI, container);
+    ASSERT_EQ(a.get(), b.get());
+    ASSERT_EQ(evmone::baseline::analysis_stats().hits, hits + 1);
+    // the cache owns the analysis, the handle found by address shares no reference count
+    ASSERT_EQ(b.use_count(), 0);
+    auto stats = evmone::baseline::analysis_stats();
+    ASSERT_GE(stats.nanoseconds, stats.analyze_nanoseconds);
+}
+
+TEST(Transaction, RunThreadedCode) {
+    using Writes = std::vector<std::tuple<evmc::bytes32, evmc::bytes32>>;
+    auto code = CODE;
+    auto inputs = std::vector<std::string>{
+        "1e010439" + to_string(10),
+        "83406251" + to_string(3) + to_string(7),
+        "8ac10b9c" + to_string(3) + to_string(7) + to_string(5),
+        "97b63212" + to_string(3) + to_string(7),
+        "a5843f08" + to_string(3) + to_string(7),
+        "ad0f98c0" + to_string(3) + to_string(7),
+        "bb27eb2c" + to_string(3) + to_string(7),
+    };
+    // run a transaction twice, the second time from its last checkpoint (at most the second), logging its writes
+    auto run = [&](auto& input, bool threaded) {
+        FLAGS_threaded_code = threaded;
+        auto writes = Writes();
+        auto table = MockTable();
+        auto checkpoints = size_t{0};
+        auto transaction = spectrum::Transaction(spectrum::EVMType::COPYONWRITE, evmc::address{0x1}, evmc::address{0x2}, std::span{code}, std::span{input});
+        transaction.InstallGetStorageHandler([&](auto& addr, auto& key) {
+            checkpoints = transaction.MakeCheckpoint() + 1;
+            return table.GetStorage(addr, key);
+        });
+        transaction.InstallSetStorageHandler([&](auto& addr, auto& key, auto& value) {
+            writes.push_back({key, value});
+            table.SetStorage(addr, key, value);
+            return evmc_storage_status::EVMC_STORAGE_ASSIGNED;
+        });
+        transaction.Execute();
+        if (checkpoints != 0) {
+            transaction.ApplyCheckpoint(std::min(checkpoints - 1, size_t{1}));
+            transaction.Execute();
+        }
+        return std::make_tuple(writes, transaction.CountOperations());
+    };
+    for (auto& hex: inputs) {
+        auto input = spectrum::from_hex(hex).value();
+        auto [writes, ops] = run(input, false);
+        auto [threaded_writes, threaded_ops] = run(input, true);
+        ASSERT_EQ(writes, threaded_writes) << hex.substr(0, 8);
+        ASSERT_GT(threaded_ops, 0);
+    }
+    FLAGS_threaded_code = false;
+}
+
+TEST(Transaction, RunIncremental) {
+    using Writes = std::vector<std::tuple<evmc::bytes32, evmc::bytes32>>;
+    auto code = CODE;
+    auto inputs = std::vector<std::string>{
+        "1e010439" + to_string(10),
+        "83406251" + to_string(3) + to_string(7),
+        "8ac10b9c" + to_string(3) + to_string(7) + to_string(5),
+        "97b63212" + to_string(3) + to_string(7),
+        "a5843f08" + to_string(3) + to_string(7),
+        "ad0f98c0" + to_string(3) + to_string(7),
+        "bb27eb2c" + to_string(3) + to_string(7),
+    };
+    // run a transaction, then replay it from its second and from its first checkpoint if it took them, logging its writes
+    auto run = [&](auto& input, spectrum::EVMType evm_type) {
+        auto writes = Writes();
+        auto table = MockTable();
+        auto checkpoints = size_t{0};
+        auto transaction = spectrum::Transaction(evm_type, evmc::address{0x1}, evmc::address{0x2}, std::span{code}, std::span{input});
+        transaction.InstallGetStorageHandler([&](auto& addr, auto& key) {
+            checkpoints = transaction.MakeCheckpoint() + 1;
+            return table.GetStorage(addr, key);
+        });
+        transaction.InstallSetStorageHandler([&](auto& addr, auto& key, auto& value) {
+            writes.push_back({key, value});
+            table.SetStorage(addr, key, value);
+            return evmc_storage_status::EVMC_STORAGE_ASSIGNED;
+        });
+        transaction.Execute();
+        if (checkpoints > 1) {
+            transaction.ApplyCheckpoint(1);
+            transaction.Execute();
+        }
+        if (checkpoints > 0) {
+            transaction.ApplyCheckpoint(0);
+            transaction.Execute();
+        }
+        return writes;
+    };
+    for (auto& hex: inputs) {
+        auto input = spectrum::from_hex(hex).value();
+        ASSERT_EQ(run(input, spectrum::EVMType::STRAWMAN), run(input, spectrum::EVMType::INCREMENTAL)) << hex.substr(0, 8);
+    }
+}
+
 }
 
 #undef CODE
@@ -10,6 +10,8 @@ class Workload {
     public:
     virtual Transaction Next() = 0;
     virtual void SetEVMType(EVMType ty) = 0;
+    // an estimate of the storage keys transactions touch, so tables can be sized upfront, 0 if unknown
+    virtual size_t CountKeys() const { return 0; }
     virtual ~Workload() = default;
 
 };
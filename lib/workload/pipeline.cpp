@@ -0,0 +1,120 @@
+#include <spectrum/workload/pipeline.hpp>
+#include <spectrum/common/wait-util.hpp>
+#include <glog/logging.h>
+#include <fmt/core.h>
+#include <chrono>
+#include <optional>
+
+DEFINE_uint64(generators, 0, "threads preparing transactions ahead of the executors, 0 generates them inline");
+
+namespace spectrum {
+
+using namespace std::chrono_literals;
+
+// generations are unique across pipelines, so a thread can tell them apart even if one reuses the address of another
+static std::atomic<size_t> pipeline_generations{0};
+
+/// @brief a pipelined workload
+/// @param inner the workload to draw transactions from, it must be safe to call from several threads
+/// @param num_generators the number of generator threads
+/// @param max_consumers the number of threads served from a ring, others generate inline
+/// @param depth the number of prepared transactions per consumer
+Pipeline::Pipeline(Workload& inner, size_t num_generators, size_t max_consumers, size_t depth):
+    inner{inner},
+    num_generators{num_generators},
+    generation{pipeline_generations.fetch_add(1) + 1}
+{
+    LOG(INFO) << fmt::format("Pipeline(num_generators={}, max_consumers={}, depth={})", num_generators, max_consumers, depth);
+    CHECK(num_generators > 0) << "a pipeline needs at least one generator";
+    for (size_t i = 0; i < max_consumers; ++i) {
+        rings.push_back(std::make_unique<SPSCRing<Transaction>>(depth));
+    }
+}
+
+Pipeline::~Pipeline() {
+    Stop();
+}
+
+/// @brief start generator threads, call after the protocol has set the evm type
+void Pipeline::Start() {
+    stop_flag.store(false);
+    num_consumers.store(0);
+    generation.store(pipeline_generations.fetch_add(1) + 1);
+    for (size_t i = 0; i < num_generators; ++i) {
+        generators.push_back(std::thread([this, i]{ Generate(i); }));
+    }
+}
+
+/// @brief stop generator threads
+void Pipeline::Stop() {
+    if (generators.empty()) { return; }
+    stop_flag.store(true);
+    for (auto& x: generators) { x.join(); }
+    generators.clear();
+    LOG(INFO) << fmt::format("Pipeline(prepared={}, inline={})", count_prepared.load(), count_inline.load());
+}
+
+/// @brief keep the rings of one generator full
+/// @param generator_id the index of this generator
+void Pipeline::Generate(size_t generator_id) {
+    auto pending = std::optional<Transaction>();
+    auto backoff = Backoff();
+    auto r       = generator_id;
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        if (!pending) { pending.emplace(inner.Next()); }
+        // offer the prepared transaction to each of our rings once, round robin
+        auto pushed = false;
+        for (auto k = generator_id; k < rings.size() && !pushed; k += num_generators) {
+            r = r + num_generators < rings.size() ? r + num_generators : generator_id;
+            pushed = rings[r]->TryPush(std::move(*pending));
+        }
+        if (pushed) {
+            pending.reset();
+            backoff.Reset();
+            count_prepared.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (!backoff.Pause()) {
+            // every ring is full, the executors are the bottleneck
+            std::this_thread::sleep_for(10us);
+        }
+    }
+}
+
+/// @brief take a prepared transaction, or generate one inline if none is ready
+/// @return the next transaction
+Transaction Pipeline::Next() {
+    thread_local auto seen  = size_t{0};
+    thread_local auto index = size_t{0};
+    if (auto current = generation.load(std::memory_order_relaxed); seen != current) {
+        seen = current; index = num_consumers.fetch_add(1);
+    }
+    if (index < rings.size()) {
+        if (auto tx = rings[index]->TryPop()) { return std::move(*tx); }
+    }
+    count_inline.fetch_add(1, std::memory_order_relaxed);
+    return inner.Next();
+}
+
+/// @brief set the evm type of generated transactions
+/// @param ty the evm type
+void Pipeline::SetEVMType(EVMType ty) {
+    CHECK(generators.empty()) << "evm type must be set before the pipeline starts";
+    inner.SetEVMType(ty);
+}
+
+/// @brief the key count of the inner workload
+size_t Pipeline::CountKeys() const {
+    return inner.CountKeys();
+}
+
+/// @brief the number of transactions generators pushed into the rings
+size_t Pipeline::CountPrepared() const {
+    return count_prepared.load();
+}
+
+/// @brief the number of transactions executors generated themselves
+size_t Pipeline::CountInline() const {
+    return count_inline.load();
+}
+
+} // namespace spectrum
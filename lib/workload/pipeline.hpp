@@ -0,0 +1,44 @@
+#pragma once
+#include <spectrum/workload/abstraction.hpp>
+#include <spectrum/common/lock-util.hpp>
+#include <gflags/gflags.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+DECLARE_uint64(generators);
+
+namespace spectrum {
+
+/// @brief a workload decorator, where generator threads prepare transactions ahead of the executors
+class Pipeline: public Workload {
+
+    private:
+    Workload&               inner;
+    size_t                  num_generators;
+    // ring i is produced by generator i % num_generators, and consumed by the i-th calling thread
+    std::vector<std::unique_ptr<SPSCRing<Transaction>>>     rings;
+    std::atomic<size_t>     num_consumers{0};
+    // renewed by every start, so threads that drew from an earlier pipeline at this address take a new ring
+    std::atomic<size_t>     generation;
+    std::atomic<size_t>     count_prepared{0};
+    std::atomic<size_t>     count_inline{0};
+    std::atomic<bool>       stop_flag{false};
+    std::vector<std::thread>    generators{};
+    void Generate(size_t generator_id);
+
+    public:
+    Pipeline(Workload& inner, size_t num_generators, size_t max_consumers, size_t depth);
+    ~Pipeline();
+    void Start();
+    void Stop();
+    Transaction Next() override;
+    void SetEVMType(EVMType ty) override;
+    size_t CountKeys() const override;
+    size_t CountPrepared() const;
+    size_t CountInline() const;
+
+};
+
+} // namespace spectrum
@@ -0,0 +1,39 @@
+#include <spectrum/workload/pipeline.hpp>
+#include <spectrum/workload/smallbank.hpp>
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <chrono>
+#include <thread>
+#include <spectrum/common/glog-prefix.hpp>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+TEST(Pipeline, ExecutorsDrawPreparedTransactions) {
+    google::InstallPrefixFormatter(PrefixFormatter);
+    auto inner    = spectrum::Smallbank(10000, 0.0);
+    auto pipeline = spectrum::Pipeline(inner, 2, 4, 16);
+    pipeline.SetEVMType(spectrum::EVMType::STRAWMAN);
+    pipeline.Start();
+    // let the generators fill the rings before anyone draws
+    std::this_thread::sleep_for(50ms);
+    auto threads = std::vector<std::thread>();
+    for (size_t i = 0; i < 6; ++i) {
+        threads.emplace_back([&]{
+            for (size_t j = 0; j < 100; ++j) {
+                auto tx = pipeline.Next();
+                tx.InstallGetStorageHandler([](auto& addr, auto& key) { return evmc::bytes32{0}; });
+                tx.InstallSetStorageHandler([](auto& addr, auto& key, auto& value) { return evmc_storage_status::EVMC_STORAGE_MODIFIED; });
+                tx.Execute();
+            }
+        });
+    }
+    for (auto& t: threads) { t.join(); }
+    pipeline.Stop();
+    ASSERT_GT(pipeline.CountPrepared(), 0);
+    // the two threads without a ring always generate inline
+    ASSERT_GE(pipeline.CountInline(), 200);
+}
+
+}
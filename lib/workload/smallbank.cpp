@@ -18,16 +18,24 @@ Smallbank::Smallbank(size_t num_elements, double zipf_exponent):
     rng{std::unique_ptr<Random>(new ThreadLocalRandom([&]{return (zipf_exponent > 0.0 ? 
         std::unique_ptr<Random>(new Zipf(num_elements, zipf_exponent)) : 
         std::unique_ptr<Random>(new Unif(num_elements))
-    );}, std::thread::hardware_concurrency()))}
+    );}, std::thread::hardware_concurrency()))},
+    num_elements{num_elements}
 {
     LOG(INFO) << fmt::format("Smallbank({}, {})", num_elements, zipf_exponent);
     this->code = spectrum::from_hex(std::string{CODE}).value();
+    PinCode(std::span{code});
+    if (FLAGS_warm_analysis) { WarmCodeAnalysis(std::span{code}); }
 }
 
 void Smallbank::SetEVMType(EVMType ty) {
     this->evm_type = ty;
 }
 
+/// @brief each account has a checking and a savings balance
+size_t Smallbank::CountKeys() const {
+    return 2 * num_elements;
+}
+
 inline std::string to_string(uint32_t key) {
     auto ss = std::ostringstream();
     ss << std::setw(64) << std::setfill('0') << key;
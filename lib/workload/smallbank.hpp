@@ -9,11 +9,13 @@ class Smallbank: public Workload {
     std::basic_string<uint8_t>  code;
     EVMType                     evm_type;
     std::unique_ptr<Random>     rng;
+    size_t                      num_elements;
 
     public:
     Smallbank(size_t num_elements, double zipf_exponent);
     Transaction Next() override;
     void SetEVMType(EVMType ty) override;
+    size_t CountKeys() const override;
 
 };
 
@@ -99,7 +99,7 @@ TEST(Smallbank, RollbackReadSame) {
             [&](auto addr, auto key) {
                 checkpoints.push_back(std::tuple{
                     transaction.MakeCheckpoint(), 
-                    spectrum::KeyHasher()({addr, key})
+                    spectrum::KeyHasher()(spectrum::StorageKey{addr, key})
                 });
                 return key;
             }
@@ -119,7 +119,7 @@ TEST(Smallbank, RollbackReadSame) {
             [&](auto addr, auto key) {
                 second_record.push_back(std::tuple{
                     transaction.MakeCheckpoint(), 
-                    spectrum::KeyHasher()({addr, key})
+                    spectrum::KeyHasher()(spectrum::StorageKey{addr, key})
                 });
                 return key;
             }
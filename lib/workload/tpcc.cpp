@@ -24,6 +24,8 @@ TPCC::TPCC(size_t num_items, size_t num_orders):
 {
     LOG(INFO) << fmt::format("TPCC({}, {})", num_items, num_orders);
     this->code = spectrum::from_hex(std::string{CODE}).value();
+    PinCode(std::span{code});
+    if (FLAGS_warm_analysis) { WarmCodeAnalysis(std::span{code}); }
 }
 
 void TPCC::SetEVMType(EVMType ty) { this->evm_type = ty; }
@@ -80,10 +80,13 @@ YCSB::YCSB(size_t num_elements, double zipf_exponent):
     rng{std::unique_ptr<Random>(new ThreadLocalRandom([&]{return (zipf_exponent > 0.0 ? 
         std::unique_ptr<Random>(new Zipf(num_elements, zipf_exponent)) : 
         std::unique_ptr<Random>(new Unif(num_elements))
-    );}, std::thread::hardware_concurrency()))}
+    );}, std::thread::hardware_concurrency()))},
+    num_elements{num_elements}
 {
     LOG(INFO) << fmt::format("YCSB({}, {})", num_elements, zipf_exponent);
     this->code = spectrum::from_hex(std::string{CODE}).value();
+    PinCode(std::span{code});
+    if (FLAGS_warm_analysis) { WarmCodeAnalysis(std::span{code}); }
     for(int i=0; i<=20; i++){
         pred_keys[i] = hexStringToBytes32(predicated_keys[i]);
     }
@@ -91,6 +94,9 @@ YCSB::YCSB(size_t num_elements, double zipf_exponent):
 
 void YCSB::SetEVMType(EVMType ty) { this->evm_type = ty; }
 
+/// @brief each element is one storage slot
+size_t YCSB::CountKeys() const { return num_elements; }
+
 inline std::string to_string(uint32_t key) {
     auto ss = std::ostringstream();
     ss << std::setw(64) << std::setfill('0') << key;
@@ -99,8 +105,8 @@ inline std::string to_string(uint32_t key) {
 
 Transaction YCSB::Next() {
     DLOG(INFO) << "ycsb next" << std::endl;
-    auto predicted_get_storage = std::unordered_set<std::tuple<evmc::address, evmc::bytes32>, KeyHasher>();
-    auto predicted_set_storage = std::unordered_set<std::tuple<evmc::address, evmc::bytes32>, KeyHasher>();
+    auto predicted_get_storage = std::unordered_set<StorageKey, KeyHasher>();
+    auto predicted_set_storage = std::unordered_set<StorageKey, KeyHasher>();
     auto input = spectrum::from_hex([&]() {
         //  10 key 5 read 5 write(may be blind)
         auto s = std::string{"f3d7af72"};
@@ -27,6 +27,7 @@ if __name__ == '__main__':
                 f"Aria:{threads}:{table_partitions}:{batch_size // threads}:TRUE",
                 f"Sparkle:{threads}:{table_partitions}", 
                 f"Spectrum:{threads}:{table_partitions}:COPYONWRITE",
+                f"SpectrumHint:{threads}:{table_partitions}:COPYONWRITE",
                 # f"SpectrumPreSched:{threads}:{table_partitions}:COPYONWRITE",
             ]
             for cc in protocols:
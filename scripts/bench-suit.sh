@@ -52,9 +52,31 @@ case $1 in
         Sparkle:16:1024
         Aria:16:1024:12:FALSE
         Spectrum:16:1024:1:COPYONWRITE
+        SpectrumHint:16:1024:COPYONWRITE
         "
         varskew "$PROTOCOL" "$BENCH"
     ;;
+    evmtype-tps)
+        BENCH="
+        Smallbank:1000000:1
+        YCSB:1000000:1
+        TPCC:10:10
+        "
+        PROTOCOL="
+        Spectrum:36:9973:BASIC
+        Spectrum:36:9973:STRAWMAN
+        Spectrum:36:9973:COPYONWRITE
+        Spectrum:36:9973:INCREMENTAL
+        "
+        for b in $BENCH; do
+            echo    "------"
+            for p in $PROTOCOL; do
+                echo    "@$p $b"
+                sleep   2
+                $EXECUTABLE  $p $b $T --logtostderr || (echo "crash"; exit)
+            done
+        done
+    ;;
     plot-skew-tps)
         BENCH=""
     ;;